@@ -0,0 +1,111 @@
+#include "Migrations.hpp"
+#include "Providers.hpp"
+#include "RequestsLog.hpp"
+#include "RulesCommitment.hpp"
+#include "ScriptAccessRules.hpp"
+#include "Scripts.hpp"
+#include "Services.hpp"
+
+namespace aggregion::migrations {
+
+   uint8_t current_keys_version(name table) {
+      if (table == Names::ScriptsTable) {
+         return KeysVersion::Scripts;
+      }
+      if (table == Names::RequestsLogTable) {
+         return KeysVersion::RequestsLog;
+      }
+      if (table == Names::ServicesTable) {
+         return KeysVersion::Services;
+      }
+      if (table == Names::ProvidersStatsTable) {
+         return KeysVersion::ProvidersStats;
+      }
+      if (table == Names::TrustedProvidersTable) {
+         return KeysVersion::TrustedProviders;
+      }
+      if (table == Names::ScriptApprovesTable) {
+         return KeysVersion::ScriptApproves;
+      }
+      if (table == Names::ScriptAccessTable) {
+         return KeysVersion::ScriptAccess;
+      }
+      if (table == Names::TrustedApprovesTable) {
+         return KeysVersion::TrustedApproves;
+      }
+      if (table == Names::RulesLeavesTable) {
+         return KeysVersion::RulesCommitment;
+      }
+      check(false, "404. Unknown table!");
+      return 0;
+   }
+
+   bool is_migrated(name self, name table) {
+      migrations_table_t migrations{self, Names::DefaultScope};
+      auto it = migrations.find(table.value);
+      return it != migrations.end() && it->version == current_keys_version(table);
+   }
+
+   /// @brief
+   /// Migration is pending once started until done with current version.
+   VisitedRows get_visited_rows(name self, name table) {
+      migrations_table_t migrations{self, Names::DefaultScope};
+      auto it = migrations.find(table.value);
+      if (it == migrations.end() || it->version == current_keys_version(table)) {
+         return VisitedRows{};
+      }
+      return VisitedRows{true, RowCursor{it->cursor, it->get_stage(), it->get_key()}};
+   }
+
+
+   /// @brief
+   /// Rewrite at most 'max_rows' rows of given table with current keys version.
+   /// Progress is kept in 'migrations' table, so action may be repeated until done.
+   void Migrations::migrate(name table, uint64_t max_rows) {
+      require_auth(get_self());
+      check(max_rows > 0, "403. Rows limit must be positive!");
+      const auto version = current_keys_version(table);
+
+      migrations_table_t migrations{get_self(), Names::DefaultScope};
+      auto it = migrations.find(table.value);
+      if (it == migrations.end()) {
+         it = migrations.emplace(get_self(), [&](Tables::Migration& row) {
+            row.table = table;
+            row.version = 0;
+            row.cursor = 0;
+         });
+      }
+      check(it->version != version, "403. Table is already migrated!");
+
+      RowCursor cursor{it->cursor, it->get_stage(), it->get_key()};
+      uint64_t count = 0;
+      if (table == Names::ScriptsTable) {
+         count = scripts::migrate_keys(get_self(), cursor.scope, max_rows);
+      } else if (table == Names::RequestsLogTable) {
+         count = migrate_requests_keys(get_self(), cursor.scope, max_rows);
+      } else if (table == Names::ServicesTable) {
+         count = services::migrate_discovery(get_self(), cursor, max_rows);
+      } else if (table == Names::ProvidersStatsTable) {
+         count = providers::migrate_provider_stats(get_self(), cursor, max_rows);
+      } else if (table == Names::TrustedProvidersTable) {
+         count = sar::migrate_trusted_by(get_self(), cursor, max_rows);
+      } else if (table == Names::ScriptApprovesTable) {
+         count = sar::migrate_script_approvers(get_self(), cursor, max_rows);
+      } else if (table == Names::ScriptAccessTable) {
+         count = sar::migrate_script_grantees(get_self(), cursor, max_rows);
+      } else if (table == Names::TrustedApprovesTable) {
+         count = sar::migrate_trusted_approves(get_self(), cursor, max_rows);
+      } else if (table == Names::RulesLeavesTable) {
+         count = commitment::migrate_rules_commitment(get_self(), cursor, max_rows);
+      }
+
+      const auto done = count < max_rows;
+      migrations.modify(it, get_self(), [&](Tables::Migration& row) {
+         row.version = done ? version : row.version;
+         row.cursor = done ? 0 : cursor.scope;
+         row.stage.emplace(done ? 0 : cursor.stage);
+         row.key.emplace(done ? 0 : cursor.key);
+      });
+      print("Table '", table, "' rows visited: ", count, " Done: ", done);
+   }
+}
@@ -0,0 +1,140 @@
+#pragma once
+
+#include "Names.hpp"
+#include "Providers.hpp"
+#include <eosio/binary_extension.hpp>
+#include <eosio/eosio.hpp>
+#include <libc/bits/stdint.h>
+#include <tuple>
+
+namespace aggregion::migrations {
+
+   using eosio::name;
+
+   /// @brief
+   /// Current versions of rows secondary keys.
+   /// Rows with lower version are rewritten by 'migrate'.
+   namespace KeysVersion {
+      /// 1 - packed version key, 2 - owner index.
+      static constexpr const uint8_t Scripts = 2;
+      /// 1 - packed request key, 2 - receiver and sender indexes, 3 - date index, 4 - payloads moved to 'reqpayloads',
+      /// 5 - date keys ordered as signed dates.
+      static constexpr const uint8_t RequestsLog = 5;
+      /// 1 - discovery index.
+      static constexpr const uint8_t Services = 1;
+      /// 1 - counters recounted.
+      static constexpr const uint8_t ProvidersStats = 1;
+      /// 1 - 'trustedby' mirror.
+      static constexpr const uint8_t TrustedProviders = 1;
+      /// 1 - 'scrapprovers' mirror.
+      static constexpr const uint8_t ScriptApproves = 1;
+      /// 1 - 'scrgrantees' mirror.
+      static constexpr const uint8_t ScriptAccess = 1;
+      /// 1 - existing trusts and approves queued for counting.
+      static constexpr const uint8_t TrustedApproves = 1;
+      /// 1 - rules committed to Merkle tree.
+      static constexpr const uint8_t RulesCommitment = 1;
+   }
+
+   struct Tables {
+
+      /// @brief
+      /// Tables migration progress.
+      /// All table rows have 'version' keys, rows before 'cursor' are already rewritten with current keys.
+      /// Migrations of provider scoped tables keep provider in 'cursor',
+      /// table within provider scope in 'stage' and next row primary key in 'key'.
+      /// Scope: Default.
+      struct [[eosio::table, eosio::contract("Aggregion")]] Migration {
+         name table;
+         uint8_t version;
+         uint64_t cursor;
+         eosio::binary_extension<uint8_t> stage;
+         eosio::binary_extension<uint64_t> key;
+
+         auto primary_key() const {
+            return table.value;
+         }
+
+         uint8_t get_stage() const {
+            return stage.has_value() ? stage.value() : 0;
+         }
+
+         uint64_t get_key() const {
+            return key.has_value() ? key.value() : 0;
+         }
+      };
+   };
+
+   using migrations_table_t = eosio::multi_index<Names::MigrationsTable, Tables::Migration>;
+
+   /// @brief
+   /// Position of migration visiting rows of provider scoped tables.
+   struct RowCursor {
+      uint64_t scope = 0;
+      uint8_t stage = 0;
+      uint64_t key = 0;
+   };
+
+   /// @brief
+   /// Rows of provider scoped tables already visited by migration.
+   /// Recounting migrations apply live changes only to visited rows, other rows are counted when visited.
+   struct VisitedRows {
+      bool pending = false;
+      RowCursor cursor;
+
+      /// True if row ('scope', 'stage', primary 'key') is visited or no migration is pending.
+      bool contains(uint64_t scope, uint8_t stage, uint64_t key) const {
+         return !pending || std::tie(scope, stage, key) < std::tie(cursor.scope, cursor.stage, cursor.key);
+      }
+   };
+
+   /// @brief
+   /// Visit at most 'limit' rows of 'table' with primary key not less than 'key'.
+   /// 'key' is moved past every visited row, returns number of visited rows.
+   template <typename Table, typename Fn>
+   uint64_t migrate_rows(Table& table, uint64_t& key, uint64_t limit, Fn&& fn) {
+      uint64_t count = 0;
+      for (auto it = table.lower_bound(key); it != table.end() && count < limit; ++it, ++count) {
+         key = it->primary_key() + 1;
+         fn(*it);
+      }
+      return count;
+   }
+
+   /// @brief
+   /// Visit at most 'limit' rows of provider scoped tables starting from 'cursor'.
+   /// 'migrate_stage(provider, stage, key, limit)' visits rows of table 'stage' of provider scope (see 'migrate_rows').
+   /// Each provider is counted as a row too, so providers without rows are bounded as well.
+   /// Returns number of visited rows.
+   template <typename Fn>
+   uint64_t migrate_provider_rows(name self, RowCursor& cursor, uint8_t stages, uint64_t limit, Fn&& migrate_stage) {
+      providers::providers_table_t providers{self, Names::DefaultScope};
+      uint64_t count = 0;
+      for (auto pit = providers.lower_bound(cursor.scope); pit != providers.end() && count < limit; ++pit) {
+         if (pit->provider.value != cursor.scope) {
+            cursor = RowCursor{pit->provider.value, 0, 0};
+         }
+         for (; cursor.stage < stages; ++cursor.stage, cursor.key = 0) {
+            count += migrate_stage(pit->provider, cursor.stage, cursor.key, limit - count);
+            if (count == limit) {
+               return count;
+            }
+         }
+         cursor = RowCursor{pit->provider.value + 1, 0, 0};
+         ++count;
+      }
+      return count;
+   }
+
+   /// @brief
+   /// Aggregion tables migration.
+   struct [[eosio::contract("Aggregion")]] Migrations : contract {
+      using contract::contract;
+
+      [[eosio::action]] void migrate(name table, uint64_t max_rows);
+   };
+
+   uint8_t current_keys_version(name table);
+   bool is_migrated(name self, name table);
+   VisitedRows get_visited_rows(name self, name table);
+}
@@ -16,19 +16,56 @@ namespace aggregion {
       static constexpr const name Contract{"aggregion"};
 
       static constexpr const name ProvidersTable{"providers"};
+      static constexpr const name ProvidersRemovalTable{"provremoval"};
+      static constexpr const name ProvidersStatsTable{"provstats"};
       static constexpr const name ServicesTable{"services"};
+      static constexpr const name ServicesDiscoveryTable{"svcdiscover"};
+      static constexpr const name ServicesDiscoveryIndex{"svcdiscidx"};
 
       static constexpr const name ScriptsTable{"scripts"};
       static constexpr const name ScriptsVersionIndex{"scrveridx"};
       static constexpr const name ScriptsHashIndex{"scrhashidx"};
+      static constexpr const name ScriptsOwnerIndex{"scrowneridx"};
+      static constexpr const name ScriptsStatsTable{"scriptstats"};
+      static constexpr const name ScriptsSequenceTable{"scriptsseq"};
 
       static constexpr const name TrustedProvidersTable{"trustedprov"};
+      static constexpr const name TrustedByTable{"trustedby"};
+      static constexpr const name TrustedApprovesTable{"trustapprvs"};
+      static constexpr const name TrustUpdatesTable{"trustupdates"};
+      static constexpr const name TrustUpdatesSequenceTable{"trustupdseq"};
+      static constexpr const name CountedTrustsTable{"trustcounted"};
+      static constexpr const name CountedApprovesTable{"apprvcounted"};
       static constexpr const name ScriptApprovesTable{"approves"};
       static constexpr const name ScriptAccessTable{"scriptaccess"};
+      static constexpr const name ScriptApproversTable{"scrapprovers"};
+      static constexpr const name ScriptGranteesTable{"scrgrantees"};
       static constexpr const name EnclaveScriptAccessTable{"encscraccess"};
+      static constexpr const name EnclaveAccessTable{"encaccess"};
+      static constexpr const name EnclaveAccessIndex{"encaccessidx"};
+      static constexpr const name ScriptEnclavesTable{"screnclaves"};
+      static constexpr const name GrantsExpiryTable{"grantexpiry"};
+      static constexpr const name GrantsExpiryIndex{"grntexpidx"};
+      static constexpr const name GrantsKeyIndex{"grntkeyidx"};
+      static constexpr const name RulesLeavesTable{"sarleaves"};
+      static constexpr const name RulesLeavesIndex{"sarleafidx"};
+      static constexpr const name RulesNodesTable{"sarnodes"};
+      static constexpr const name RulesRootTable{"sarroot"};
 
       static constexpr const name RequestsLogTable{"reqslog"};
       static constexpr const name RequestsLogIndex{"reqslogidx"};
+      static constexpr const name RequestsReceiverIndex{"reqrcvidx"};
+      static constexpr const name RequestsSenderIndex{"reqsndidx"};
+      static constexpr const name RequestsDateIndex{"reqdateidx"};
+      static constexpr const name RequestsConfigTable{"reqsconfig"};
+      static constexpr const name RequestsCheckpointsTable{"reqchkpts"};
+      static constexpr const name RequestsPayloadsTable{"reqpayloads"};
+      static constexpr const name RequestsPayloadsIndex{"reqpayidx"};
+      static constexpr const name RequestsStatsTable{"reqstats"};
+      static constexpr const name RequestsStatsIndex{"reqstatsidx"};
+      static constexpr const name RequestsNotifyPermission{"notify"};
+
+      static constexpr const name MigrationsTable{"migrations"};
 
    };
 }
@@ -1,5 +1,11 @@
 #include "Providers.hpp"
+#include "Migrations.hpp"
+#include "ScriptAccessRules.hpp"
+#include "Scripts.hpp"
+#include "Services.hpp"
 #include "Utility.hpp"
+#include <algorithm>
+#include <limits>
 
 
 namespace aggregion {
@@ -31,6 +37,9 @@ namespace aggregion {
          providers_table_t providers{get_self(), Names::DefaultScope};
          auto it = providers.require_find(provider.value, "404. Unknown provider!");
 
+         providers_removal_table_t removals{get_self(), Names::DefaultScope};
+         check(removals.find(provider.value) == removals.end(), "403. Provider is being unregistered!");
+
          providers.modify(it, get_self(), [&](auto& row) {
             row.description = description;
          });
@@ -40,25 +49,246 @@ namespace aggregion {
 
       /// @brief
       /// Unregister service provider.
+      /// Provider with many dependent rows stays pending until 'cleanup' drains them.
       void Aggregion::unregprov(name provider) {
          check(has_auth(provider) || has_auth(get_self()), "missing authority");
 
          providers_table_t providers{get_self(), Names::DefaultScope};
-         auto it = providers.require_find(provider.value, "404. Unknown provider!");
+         providers.require_find(provider.value, "404. Unknown provider!");
+
+         providers_removal_table_t removals{get_self(), Names::DefaultScope};
+         check(removals.find(provider.value) == removals.end(), "403. Provider is already being unregistered!");
+
+         removals.emplace(get_self(), [&](auto& row) {
+            row.provider = provider;
+            row.stage = static_cast<uint8_t>(RemovalStage::Services);
+            row.removed = 0;
+            row.updates_end = 0;
+         });
+         continue_removal(provider, UnregisterBatchSize);
+      }
+
+
+      /// @brief
+      /// Continue pending provider unregistration.
+      /// Erases at most 'max_rows' dependent rows per call.
+      void Aggregion::cleanup(name provider, uint64_t max_rows) {
+         check(has_auth(provider) || has_auth(get_self()), "missing authority");
+         check(max_rows > 0, "403. Rows limit must be positive!");
+         continue_removal(provider, max_rows);
+      }
 
-         remove_provider_services(get_self(), provider);
-         remove_provider_trusts(get_self(), provider);
-         remove_provider_approves(get_self(), provider);
-         remove_provider_accesses(get_self(), provider);
-         remove_provider_enclave_accesses(get_self(), provider);
 
+      void Aggregion::continue_removal(name provider, uint64_t max_rows) {
+         providers_removal_table_t removals{get_self(), Names::DefaultScope};
+         auto rit = removals.require_find(provider.value, "404. Provider is not being unregistered!");
+
+         auto stage = static_cast<RemovalStage>(rit->stage);
+         auto updates_end = rit->updates_end;
+         uint64_t removed = 0;
+         while (stage != RemovalStage::Done && removed < max_rows) {
+            const auto limit = max_rows - removed;
+            uint64_t count = 0;
+            switch (stage) {
+            case RemovalStage::Services:
+               count = remove_provider_services(get_self(), provider, limit);
+               break;
+            case RemovalStage::Trusts:
+               count = remove_provider_trusts(get_self(), provider, limit);
+               break;
+            case RemovalStage::Approves:
+               count = remove_provider_approves(get_self(), provider, limit);
+               break;
+            case RemovalStage::Accesses:
+               count = remove_provider_accesses(get_self(), provider, limit);
+               break;
+            case RemovalStage::EnclaveAccesses:
+               count = remove_provider_enclave_accesses(get_self(), provider, limit);
+               break;
+            case RemovalStage::InboundTrusts:
+               count = remove_provider_inbound_trusts(get_self(), provider, limit);
+               break;
+            case RemovalStage::TrustedApproves:
+               // Counts of provider are dropped by updates queued by previous stages.
+               count = sar::apply_trust_updates(get_self(), limit, updates_end);
+               break;
+            default:
+               check(false, "500. Unknown removal stage");
+            }
+            removed += count;
+            if (count < limit) {
+               stage = static_cast<RemovalStage>(static_cast<uint8_t>(stage) + 1);
+               if (stage == RemovalStage::TrustedApproves) {
+                  updates_end = sar::next_trust_update_id(get_self());
+               }
+            }
+         }
+
+         if (stage != RemovalStage::Done) {
+            removals.modify(rit, get_self(), [&](auto& row) {
+               row.stage = static_cast<uint8_t>(stage);
+               row.removed += removed;
+               row.updates_end = updates_end;
+            });
+            print("Provider '", provider, "' unregistration is pending. Rows removed: ", rit->removed);
+            return;
+         }
+
+         removals.erase(rit);
+         providers_table_t providers{get_self(), Names::DefaultScope};
+         auto it = providers.require_find(provider.value, "500. Unknown provider!");
          providers.erase(it);
+
+         // Only owned scripts outlive provider.
+         provider_stats_table_t stats{get_self(), Names::DefaultScope};
+         auto sit = stats.find(provider.value);
+         if (sit != stats.end() && sit->scripts == 0) {
+            stats.erase(sit);
+         }
          print("Provider '", provider, "' was unregistered.");
       }
+
+
+      /// @brief
+      /// Read-only. Provider counters.
+      Tables::ProviderStats Aggregion::getprovstats(name provider) {
+         provider_stats_table_t stats{get_self(), Names::DefaultScope};
+         auto it = stats.find(provider.value);
+         Tables::ProviderStats result{};
+         result.provider = provider;
+         if (it != stats.end()) {
+            result = *it;
+         }
+         print("Provider '", provider, "' services:", result.services, " scripts:", result.scripts, " trusts:", result.trusts,
+               " approves:", result.approves, " grants:", result.grants);
+         return result;
+      }
+
+
+      void reset_provider_stat(name self, name provider, ProviderCounter counter) {
+         provider_stats_table_t stats{self, Names::DefaultScope};
+         auto it = stats.find(provider.value);
+         if (it != stats.end()) {
+            stats.modify(it, self, [&](Tables::ProviderStats& row) {
+               row.counter(counter) = 0;
+            });
+         }
+      }
+
+      /// @brief
+      /// Scripts stage key after last owned script was counted.
+      static constexpr const uint64_t AllScriptsCounted = std::numeric_limits<uint64_t>::max();
+
+      /// @brief
+      /// Count at most 'limit' owned scripts of provider by owner index.
+      /// 'key' is id of next script plus one, slice restarts if that script was removed meanwhile.
+      uint64_t count_owned_scripts(name self, name provider, uint64_t& key, uint64_t limit, uint64_t& counted) {
+         if (key == AllScriptsCounted) {
+            return 0;
+         }
+         scripts::scripts_table_t scripts{self, Names::DefaultScope};
+         auto owner_idx = scripts.get_index<Names::ScriptsOwnerIndex>();
+         const auto end = owner_idx.lower_bound(common::Keys::pack(provider.value + 1, 0));
+         auto it = owner_idx.lower_bound(common::Keys::pack(provider.value, 0));
+         if (key != 0) {
+            auto sit = scripts.find(key - 1);
+            if (sit != scripts.end() && sit->owner == provider) {
+               it = owner_idx.iterator_to(*sit);
+            } else {
+               reset_provider_stat(self, provider, ProviderCounter::Scripts);
+            }
+         }
+         uint64_t count = 0;
+         for (; it != end && count < limit; ++it, ++count) {
+            ++counted;
+         }
+         key = it == end ? AllScriptsCounted : it->id + 1;
+         return count;
+      }
+
+      /// @brief
+      /// Recount counters of providers starting from 'cursor'.
+      /// Each counter is recounted by its own stage: counter is reset when stage starts,
+      /// visited rows are added to it, so per call work is bounded by number of rows.
+      /// Changes of rows not visited yet are skipped by 'add_provider_row_stat', they are counted when visited.
+      /// Scripts are counted by owner index, so 'scripts' table must be migrated first.
+      /// Returns number of visited rows.
+      uint64_t migrate_provider_stats(name self, migrations::RowCursor& cursor, uint64_t limit) {
+         constexpr uint8_t stages = static_cast<uint8_t>(ProviderCounter::Grants) + 1;
+         return migrations::migrate_provider_rows(self, cursor, stages, limit, [&](name p, uint8_t stage, uint64_t& key, uint64_t rows) {
+            const auto counter = static_cast<ProviderCounter>(stage);
+            if (key == 0) {
+               reset_provider_stat(self, p, counter);
+            }
+            uint64_t counted = 0;
+            uint64_t count = 0;
+            switch (counter) {
+            case ProviderCounter::Services: {
+               services::services_table_t services{self, p.value};
+               count = migrations::migrate_rows(services, key, rows, [&](const auto&) { ++counted; });
+               break;
+            }
+            case ProviderCounter::Scripts:
+               count = count_owned_scripts(self, p, key, rows, counted);
+               break;
+            case ProviderCounter::Trusts: {
+               sar::trusted_providers_table_t trusted{self, p.value};
+               count = migrations::migrate_rows(trusted, key, rows, [&](const auto& t) { counted += t.trust ? 1 : 0; });
+               break;
+            }
+            case ProviderCounter::Approves: {
+               sar::script_approves_table_t approves{self, p.value};
+               count = migrations::migrate_rows(approves, key, rows, [&](const auto& a) { counted += a.approved ? 1 : 0; });
+               break;
+            }
+            case ProviderCounter::Grants: {
+               sar::script_access_table_t access{self, p.value};
+               count = migrations::migrate_rows(access, key, rows, [&](const auto& a) { counted += a.granted ? 1 : 0; });
+               break;
+            }
+            }
+            add_provider_stat(self, p, counter, counted);
+            return count;
+         });
+      }
    }
 
    bool is_provider(name self, name provider) {
       providers::providers_table_t providers{self, Names::DefaultScope};
-      return providers.find(provider.value) != providers.end();
+      if (providers.find(provider.value) == providers.end()) {
+         return false;
+      }
+      providers::providers_removal_table_t removals{self, Names::DefaultScope};
+      return removals.find(provider.value) == removals.end();
+   }
+
+   void add_provider_stat(name self, name provider, ProviderCounter counter, int64_t delta) {
+      if (delta == 0)
+         return;
+      providers::provider_stats_table_t stats{self, Names::DefaultScope};
+      auto it = stats.find(provider.value);
+      if (it == stats.end()) {
+         it = stats.emplace(self, [&](providers::Tables::ProviderStats& row) {
+            row.provider = provider;
+         });
+      }
+      stats.modify(it, self, [&](providers::Tables::ProviderStats& row) {
+         auto& value = row.counter(counter);
+         // Rows written before counters were introduced are not counted.
+         value = delta < 0 && value < static_cast<uint64_t>(-delta) ? 0 : value + delta;
+      });
+   }
+
+   void add_provider_row_stat(name self, name provider, ProviderCounter counter, uint64_t key, int64_t delta) {
+      const auto visited = migrations::get_visited_rows(self, Names::ProvidersStatsTable);
+      if (visited.contains(provider.value, static_cast<uint8_t>(counter), key)) {
+         add_provider_stat(self, provider, counter, delta);
+         return;
+      }
+      // Accounts without provider row are not recounted.
+      providers::providers_table_t providers{self, Names::DefaultScope};
+      if (providers.find(provider.value) == providers.end()) {
+         add_provider_stat(self, provider, counter, delta);
+      }
    }
 }
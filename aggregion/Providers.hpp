@@ -1,14 +1,37 @@
 #pragma once
 
 #include "Names.hpp"
+#include "Utility.hpp"
 #include <eosio/crypto.hpp>
 #include <eosio/eosio.hpp>
 #include <libc/bits/stdint.h>
 
+namespace aggregion::migrations {
+   struct RowCursor;
+}
+
 namespace aggregion::providers {
 
    using eosio::name;
 
+   /// @brief
+   /// Rows removed by 'unregprov' itself before it falls back to 'cleanup' calls.
+   static constexpr const uint64_t UnregisterBatchSize = 100;
+
+   /// @brief
+   /// Provider dependent tables drained by unregistration (in order).
+   /// Stage values are stored in pending removals, new stages go before 'Done'.
+   enum class RemovalStage : uint8_t {
+      Services,
+      Trusts,
+      Approves,
+      Accesses,
+      EnclaveAccesses,
+      InboundTrusts,
+      TrustedApproves,
+      Done,
+   };
+
    struct Tables {
 
       /// @brief
@@ -22,9 +45,62 @@ namespace aggregion::providers {
             return provider.value;
          }
       };
+
+      /// @brief
+      /// Providers pending removal.
+      /// Dependent rows are erased from the beginning of each provider scope,
+      /// so the scope begin is the cursor of the table named by 'stage'.
+      /// 'TrustedApproves' stage applies trust updates queued before it ('updates_end' is next update id then).
+      /// Scope: Default.
+      struct [[eosio::table, eosio::contract("Aggregion")]] ProviderRemoval {
+         name provider;
+         uint8_t stage;
+         uint64_t removed;
+         uint64_t updates_end = 0;
+
+         auto primary_key() const {
+            return provider.value;
+         }
+      };
+
+      /// @brief
+      /// Provider counters, updated by every action changing counted rows.
+      /// Row may exist for any script owner, not only for registered provider.
+      /// Scope: Default.
+      struct [[eosio::table, eosio::contract("Aggregion")]] ProviderStats {
+         name provider;
+         uint64_t services = 0;
+         uint64_t scripts = 0;
+         uint64_t trusts = 0;
+         uint64_t approves = 0;
+         uint64_t grants = 0;
+
+         auto primary_key() const {
+            return provider.value;
+         }
+
+         uint64_t& counter(ProviderCounter c) {
+            switch (c) {
+            case ProviderCounter::Services:
+               return services;
+            case ProviderCounter::Scripts:
+               return scripts;
+            case ProviderCounter::Trusts:
+               return trusts;
+            case ProviderCounter::Approves:
+               return approves;
+            case ProviderCounter::Grants:
+               return grants;
+            }
+            check(false, "500. Unknown provider counter");
+            return services;
+         }
+      };
    };
 
    using providers_table_t = eosio::multi_index<Names::ProvidersTable, Tables::Provider>;
+   using providers_removal_table_t = eosio::multi_index<Names::ProvidersRemovalTable, Tables::ProviderRemoval>;
+   using provider_stats_table_t = eosio::multi_index<Names::ProvidersStatsTable, Tables::ProviderStats>;
 
    /// @brief
    /// Aggregion providers smart contract.
@@ -35,6 +111,12 @@ namespace aggregion::providers {
       [[eosio::action]] void regprov(std::string provider, std::string description);
       [[eosio::action]] void updprov(name provider, std::string description);
       [[eosio::action]] void unregprov(name provider);
+      [[eosio::action]] void cleanup(name provider, uint64_t max_rows);
+      [[eosio::action]] Tables::ProviderStats getprovstats(name provider);
+
+   private:
+      void continue_removal(name provider, uint64_t max_rows);
    };
 
-}
\ No newline at end of file
+   uint64_t migrate_provider_stats(name self, migrations::RowCursor& cursor, uint64_t limit);
+}
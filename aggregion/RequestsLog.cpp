@@ -1,7 +1,70 @@
 #include "RequestsLog.hpp"
+#include "Migrations.hpp"
+#include <eosio/system.hpp>
 
 namespace aggregion {
 
+   /// @brief
+   /// Reference payload, storing it on first use.
+   void acquire_payload(name self, const checksum256& hash, const std::string& payload) {
+      reqs_payloads_table_t payloads{self, Names::DefaultScope};
+      auto idx = payloads.get_index<Names::RequestsPayloadsIndex>();
+      auto it = idx.find(hash);
+      if (it != idx.end()) {
+         idx.modify(it, self, [&](Tables::RequestPayload& row) {
+            row.refs += 1;
+         });
+         return;
+      }
+      payloads.emplace(self, [&](Tables::RequestPayload& row) {
+         row.id = payloads.available_primary_key();
+         row.hash = hash;
+         row.payload = payload;
+         row.refs = 1;
+      });
+   }
+
+   /// @brief
+   /// Dereference payload, removing it when it is not used anymore.
+   void release_payload(name self, const checksum256& hash) {
+      reqs_payloads_table_t payloads{self, Names::DefaultScope};
+      auto idx = payloads.get_index<Names::RequestsPayloadsIndex>();
+      auto it = idx.find(hash);
+      if (it == idx.end())
+         return;
+      if (it->refs > 1) {
+         idx.modify(it, self, [&](Tables::RequestPayload& row) {
+            row.refs -= 1;
+         });
+         return;
+      }
+      idx.erase(it);
+   }
+
+
+   /// @brief
+   /// Count request in sender's daily traffic to receiver.
+   void add_request_stats(name self, name sender, name receiver, int date, uint64_t bytes) {
+      const auto day = request_day(date);
+      reqs_stats_table_t stats{self, sender.value};
+      auto idx = stats.get_index<Names::RequestsStatsIndex>();
+      auto it = idx.find(Tables::RequestsStats::makeKey(day, receiver));
+      if (it != idx.end()) {
+         idx.modify(it, self, [&](Tables::RequestsStats& row) {
+            row.count += 1;
+            row.bytes += bytes;
+         });
+         return;
+      }
+      stats.emplace(self, [&](Tables::RequestsStats& row) {
+         row.id = stats.available_primary_key();
+         row.receiver = receiver;
+         row.day = day;
+         row.count = 1;
+         row.bytes = bytes;
+      });
+   }
+
 
    /// @brief
    /// Add new 'request' item.
@@ -10,20 +73,160 @@ namespace aggregion {
       const auto r = name{receiver};
       require_auth(s);
 
+      reqs_config_t config{get_self(), Names::DefaultScope};
+      check(date >= config.get_or_default().pruned_before, "403. Request date is out of retention window!");
+
       reqlog_table_t logreq{get_self(), Names::DefaultScope};
       auto idx = logreq.get_index<Names::RequestsLogIndex>();
-      auto key = Tables::RequestsLog::makeKey(s, r, date, request);
+      const auto hash = sha256(request.data(), request.size());
+      auto key = Tables::RequestsLog::makeKey(s, r, date, hash);
       auto lrit = idx.find(key);
       check(lrit == idx.end(), "403. Specified request is already exists!");
+      if (!migrations::is_migrated(get_self(), Names::RequestsLogTable)) {
+         lrit = idx.find(Tables::RequestsLog::makeLegacyKey(s, r, date, request));
+         check(lrit == idx.end() || lrit->get_keys_version() != 0, "403. Specified request is already exists!");
+      }
 
+      acquire_payload(get_self(), hash, request);
+      add_request_stats(get_self(), s, r, date, request.size());
       auto id = logreq.available_primary_key();
       logreq.emplace(get_self(), [&](auto& row) {
          row.id = id;
          row.sender = s;
          row.receiver = r;
          row.date = date;
-         row.request = request;
+         row.keys_version.emplace(migrations::KeysVersion::RequestsLog);
+         row.request_hash.emplace(hash);
       });
       print("Request was added. Sender:'", s, "' Receiver:'", r, "' Date:'", date, "'. Id:", id);
+
+      // Receiver may be any name, only existing accounts can be notified.
+      // Inline action is authorized by 'notify' permission linked to 'reqnotify' only, not by 'active'.
+      if (is_account(r)) {
+         reqnotify_action notify{get_self(), {get_self(), Names::RequestsNotifyPermission}};
+         notify.send(id, s, r, date, hash);
+      }
+   }
+
+
+   /// @brief
+   /// Read-only. Sender traffic per receiver for days in [from_day, to_day].
+   std::vector<Tables::RequestsStats> RequestsLog::getreqstats(name sender, int32_t from_day, int32_t to_day) {
+      check(from_day <= to_day, "403. Invalid days range!");
+
+      std::vector<Tables::RequestsStats> result;
+      reqs_stats_table_t stats{get_self(), sender.value};
+      auto idx = stats.get_index<Names::RequestsStatsIndex>();
+      const auto end = idx.upper_bound(Tables::RequestsStats::makeKey(to_day, name{std::numeric_limits<uint64_t>::max()}));
+      for (auto it = idx.lower_bound(Tables::RequestsStats::makeKey(from_day, name{})); it != end; ++it) {
+         result.push_back(*it);
+         print(it->day, " ", it->receiver, " count:", it->count, " bytes:", it->bytes, "\n");
+      }
+      return result;
+   }
+
+
+   /// @brief
+   /// Deliver request descriptor to receiver account. Sent inline by 'sendreq'.
+   void RequestsLog::reqnotify(uint64_t id, name sender, name receiver, int date, checksum256 request_hash) {
+      require_auth(get_self());
+      require_recipient(receiver);
+   }
+
+
+   /// @brief
+   /// Set requests log retention window.
+   void RequestsLog::setretention(uint32_t retention) {
+      require_auth(get_self());
+
+      reqs_config_t config{get_self(), Names::DefaultScope};
+      auto cfg = config.get_or_default();
+      cfg.retention = retention;
+      config.set(cfg, get_self());
+      print("Requests retention: ", retention);
+   }
+
+
+   /// @brief
+   /// Remove at most 'max_rows' oldest requests dated before 'before_date'.
+   /// Window is measured from current block time, dates given by senders don't move it.
+   /// Removed rows are folded into rolling checkpoint digest, a checkpoint row is written per call.
+   void RequestsLog::prunereqs(int before_date, uint64_t max_rows) {
+      require_auth(get_self());
+      check(max_rows > 0, "403. Rows limit must be positive!");
+      check(migrations::is_migrated(get_self(), Names::RequestsLogTable), "403. Requests log is not migrated!");
+
+      reqs_config_t config{get_self(), Names::DefaultScope};
+      auto cfg = config.get_or_default();
+      check(cfg.retention > 0, "403. Retention is not configured!");
+
+      const int64_t now = eosio::current_time_point().sec_since_epoch();
+      check(before_date <= now - cfg.retention, "403. Date is inside retention window!");
+
+      reqlog_table_t logreq{get_self(), Names::DefaultScope};
+      auto idx = logreq.get_index<Names::RequestsDateIndex>();
+
+      auto digest = cfg.checkpoint;
+      int from_date = 0;
+      int to_date = 0;
+      uint64_t count = 0;
+      for (auto it = idx.begin(); it != idx.end() && it->date < before_date && count < max_rows; ++count) {
+         if (count == 0)
+            from_date = it->date;
+         to_date = it->date;
+         digest = common::Keys::hash(digest, Tables::RequestsLog::makeKey(it->sender, it->receiver, it->date, it->get_request_hash()));
+         if (it->request_hash.has_value()) {
+            release_payload(get_self(), it->request_hash.value());
+         }
+         it = idx.erase(it);
+      }
+
+      if (count > 0) {
+         reqs_checkpoints_table_t checkpoints{get_self(), Names::DefaultScope};
+         checkpoints.emplace(get_self(), [&](Tables::RequestsCheckpoint& row) {
+            row.id = checkpoints.available_primary_key();
+            row.from_date = from_date;
+            row.to_date = to_date;
+            row.count = count;
+            row.digest = digest;
+         });
+      }
+      cfg.checkpoint = digest;
+      cfg.pruned_count += count;
+      cfg.pruned_before = std::max(cfg.pruned_before, before_date);
+      config.set(cfg, get_self());
+      print("Requests pruned: ", count, " Done: ", count < max_rows);
+   }
+
+
+   /// @brief
+   /// Rewrite requests starting from 'cursor' with current keys version.
+   /// Returns number of visited rows (less than 'limit' when table end is reached).
+   uint64_t migrate_requests_keys(name self, uint64_t& cursor, uint64_t limit) {
+      reqlog_table_t logreq{self, Names::DefaultScope};
+      uint64_t count = 0;
+      for (; count < limit; ++count) {
+         auto it = logreq.lower_bound(cursor);
+         if (it == logreq.end())
+            break;
+         cursor = it->id + 1;
+         if (it->get_keys_version() == migrations::KeysVersion::RequestsLog)
+            continue;
+
+         // Reinsert row, so every secondary index gets current key.
+         auto row = *it;
+         logreq.erase(it);
+         if (!row.request_hash.has_value()) {
+            const auto hash = row.get_request_hash();
+            acquire_payload(self, hash, row.request);
+            row.request_hash.emplace(hash);
+            row.request.clear();
+         }
+         row.keys_version.emplace(migrations::KeysVersion::RequestsLog);
+         logreq.emplace(self, [&](Tables::RequestsLog& r) {
+            r = row;
+         });
+      }
+      return count;
    }
 }
@@ -1,16 +1,34 @@
 #pragma once
 
+#include "../common/Keys.hpp"
 #include "Names.hpp"
+#include <eosio/binary_extension.hpp>
 #include <eosio/crypto.hpp>
 #include <eosio/eosio.hpp>
+#include <eosio/singleton.hpp>
 #include <libc/bits/stdint.h>
+#include <limits>
 
 namespace aggregion {
 
+   /// @brief
+   /// Requests statistics bucket. Request dates are seconds since epoch (UTC).
+   static constexpr const int64_t RequestsStatsBucket = 24 * 60 * 60;
+
+   /// @brief
+   /// Day number of request 'date', rounded down, so dates before epoch get negative days.
+   inline int32_t request_day(int date) {
+      const int64_t d = date;
+      return static_cast<int32_t>((d < 0 ? d - (RequestsStatsBucket - 1) : d) / RequestsStatsBucket);
+   }
+
    struct Tables {
 
       /// @brief
       /// Requests log.
+      /// Indexed by (receiver, date) and (sender, date) for date range queries.
+      /// Request body is kept in 'RequestPayload' row referenced by 'request_hash',
+      /// 'request' is filled only in rows written before keys version 4.
       /// Scope: Default.
       struct [[eosio::table, eosio::contract("Aggregion")]] RequestsLog {
          uint64_t id;
@@ -18,12 +36,31 @@ namespace aggregion {
          name receiver;
          int date;
          std::string request;
+         eosio::binary_extension<uint8_t> keys_version;
+         eosio::binary_extension<checksum256> request_hash;
 
          auto primary_key() const {
             return id;
          }
 
-         static auto makeKey(name sender, name receiver, int date, std::string const& request) {
+         uint8_t get_keys_version() const {
+            return keys_version.has_value() ? keys_version.value() : 0;
+         }
+
+         checksum256 get_request_hash() const {
+            return request_hash.has_value() ? request_hash.value() : sha256(request.data(), request.size());
+         }
+
+         /// @brief
+         /// Request key: hash of packed (sender, receiver, date) and request hash.
+         static auto makeKey(name sender, name receiver, int date, const checksum256& request_hash) {
+            const auto header = common::Keys::pack(sender.value, receiver.value, static_cast<uint32_t>(date));
+            return common::Keys::hash(header, request_hash);
+         }
+
+         /// @brief
+         /// Request key of rows written before keys version 1.
+         static auto makeLegacyKey(name sender, name receiver, int date, std::string const& request) {
             std::string value;
             value.append(sender.to_string());
             value.append(receiver.to_string());
@@ -33,14 +70,122 @@ namespace aggregion {
             return sha256(value.data(), value.size());
          }
 
-         auto secondary_key() const {
-            return makeKey(sender, receiver, date, request);
+         checksum256 secondary_key() const {
+            if (get_keys_version() == 0) {
+               return makeLegacyKey(sender, receiver, date, request);
+            }
+            return makeKey(sender, receiver, date, get_request_hash());
+         }
+
+         /// @brief
+         /// Date ordered key of account requests.
+         static uint128_t makeDateKey(name account, int date) {
+            return common::Keys::pack(account.value, common::Keys::ordered(date));
+         }
+
+         /// @brief
+         /// Date key of rows written before keys version 5, negative dates go after positive ones.
+         static uint128_t makeLegacyDateKey(name account, int date) {
+            return common::Keys::pack(account.value, static_cast<uint32_t>(date));
+         }
+
+         uint128_t receiver_key() const {
+            return get_keys_version() < 5 ? makeLegacyDateKey(receiver, date) : makeDateKey(receiver, date);
+         }
+
+         uint128_t sender_key() const {
+            return get_keys_version() < 5 ? makeLegacyDateKey(sender, date) : makeDateKey(sender, date);
+         }
+
+         uint64_t date_key() const {
+            return get_keys_version() < 5 ? static_cast<uint32_t>(date) : common::Keys::ordered(date);
+         }
+      };
+
+      /// @brief
+      /// Requests log retention settings and pruning state.
+      /// 'retention' is measured in seconds behind current block time, 0 disables pruning.
+      /// Requests dated before 'pruned_before' are rejected, their duplicates can't be detected anymore.
+      /// Scope: Default.
+      struct [[eosio::table, eosio::contract("Aggregion")]] RequestsConfig {
+         uint32_t retention = 0;
+         int pruned_before = std::numeric_limits<int>::min();
+         checksum256 checkpoint;
+         uint64_t pruned_count = 0;
+      };
+
+      /// @brief
+      /// Requests bodies, stored once per content.
+      /// 'refs' is number of log rows referencing the payload.
+      /// Scope: Default.
+      struct [[eosio::table, eosio::contract("Aggregion")]] RequestPayload {
+         uint64_t id;
+         checksum256 hash;
+         std::string payload;
+         uint64_t refs;
+
+         auto primary_key() const {
+            return id;
+         }
+
+         auto payload_hash_key() const {
+            return hash;
+         }
+      };
+
+      /// @brief
+      /// Requests traffic per receiver per day (see 'request_day').
+      /// 'bytes' is total size of sent requests bodies.
+      /// Scope: Sender.
+      struct [[eosio::table, eosio::contract("Aggregion")]] RequestsStats {
+         uint64_t id;
+         name receiver;
+         int32_t day;
+         uint64_t count;
+         uint64_t bytes;
+
+         auto primary_key() const {
+            return id;
+         }
+
+         static uint128_t makeKey(int32_t day, name receiver) {
+            return common::Keys::pack(common::Keys::ordered(day), receiver.value);
+         }
+
+         uint128_t day_key() const {
+            return makeKey(day, receiver);
+         }
+      };
+
+      /// @brief
+      /// Digests of pruned requests ranges.
+      /// 'digest' chains request keys of all pruned rows in (date, id) order, starting from zero digest:
+      /// digest = sha256(digest + request key).
+      /// Scope: Default.
+      struct [[eosio::table, eosio::contract("Aggregion")]] RequestsCheckpoint {
+         uint64_t id;
+         int from_date;
+         int to_date;
+         uint64_t count;
+         checksum256 digest;
+
+         auto primary_key() const {
+            return id;
          }
       };
    };
 
    using logreq_index_t = indexed_by<Names::RequestsLogIndex, const_mem_fun<Tables::RequestsLog, checksum256, &Tables::RequestsLog::secondary_key>>;
-   using reqlog_table_t = eosio::multi_index<Names::RequestsLogTable, Tables::RequestsLog, logreq_index_t>;
+   using logreq_receiver_index_t = indexed_by<Names::RequestsReceiverIndex, const_mem_fun<Tables::RequestsLog, uint128_t, &Tables::RequestsLog::receiver_key>>;
+   using logreq_sender_index_t = indexed_by<Names::RequestsSenderIndex, const_mem_fun<Tables::RequestsLog, uint128_t, &Tables::RequestsLog::sender_key>>;
+   using logreq_date_index_t = indexed_by<Names::RequestsDateIndex, const_mem_fun<Tables::RequestsLog, uint64_t, &Tables::RequestsLog::date_key>>;
+   using reqlog_table_t = eosio::multi_index<Names::RequestsLogTable, Tables::RequestsLog, logreq_index_t, logreq_receiver_index_t, logreq_sender_index_t, logreq_date_index_t>;
+   using reqs_payload_index_t = indexed_by<Names::RequestsPayloadsIndex, const_mem_fun<Tables::RequestPayload, checksum256, &Tables::RequestPayload::payload_hash_key>>;
+   using reqs_payloads_table_t = eosio::multi_index<Names::RequestsPayloadsTable, Tables::RequestPayload, reqs_payload_index_t>;
+   using reqs_stats_index_t = indexed_by<Names::RequestsStatsIndex, const_mem_fun<Tables::RequestsStats, uint128_t, &Tables::RequestsStats::day_key>>;
+   using reqs_stats_table_t = eosio::multi_index<Names::RequestsStatsTable, Tables::RequestsStats, reqs_stats_index_t>;
+   using reqs_config_t = eosio::singleton<Names::RequestsConfigTable, Tables::RequestsConfig>;
+   using reqs_checkpoints_table_t = eosio::multi_index<Names::RequestsCheckpointsTable, Tables::RequestsCheckpoint>;
 
 
    /// @brief
@@ -49,5 +194,17 @@ namespace aggregion {
       using contract::contract;
 
       [[eosio::action]] void sendreq(std::string sender, std::string receiver, int date, std::string request);
+      [[eosio::action]] void setretention(uint32_t retention);
+      [[eosio::action]] void prunereqs(int before_date, uint64_t max_rows);
+      [[eosio::action]] std::vector<Tables::RequestsStats> getreqstats(name sender, int32_t from_day, int32_t to_day);
+      [[eosio::action]] void reqnotify(uint64_t id, name sender, name receiver, int date, checksum256 request_hash);
+
+      using reqnotify_action = eosio::action_wrapper<"reqnotify"_n, &RequestsLog::reqnotify>;
    };
+
+   void acquire_payload(name self, const checksum256& hash, const std::string& payload);
+   void release_payload(name self, const checksum256& hash);
+   void add_request_stats(name self, name sender, name receiver, int date, uint64_t bytes);
+
+   uint64_t migrate_requests_keys(name self, uint64_t& cursor, uint64_t limit);
 }
\ No newline at end of file
@@ -0,0 +1,241 @@
+#include "RulesCommitment.hpp"
+#include "Migrations.hpp"
+#include "Providers.hpp"
+#include "ScriptAccessRules.hpp"
+#include "Scripts.hpp"
+
+namespace aggregion::commitment {
+
+   checksum256 make_rule_key(RuleKind kind, uint64_t a, uint64_t b, uint64_t c) {
+      return common::Keys::pack(static_cast<uint64_t>(kind), a, b, c);
+   }
+
+   checksum256 leaf_hash(const Tables::RuleLeaf& leaf) {
+      return common::Keys::hash(leaf.rule, common::Keys::pack(leaf.value ? 1 : 0, leaf.expires_at, 0));
+   }
+
+   checksum256 node_hash(const checksum256& left, const checksum256& right) {
+      static const checksum256 zero{};
+      if (left == zero && right == zero) {
+         return zero;
+      }
+      return common::Keys::hash(left, right);
+   }
+
+   uint64_t node_id(uint8_t level, uint64_t index) {
+      return (static_cast<uint64_t>(level) << 32) | index;
+   }
+
+   /// @brief
+   /// Node hash at given level, absent node is zero.
+   checksum256 get_node(const rules_leaves_table_t& leaves, const rules_nodes_table_t& nodes, uint8_t level, uint64_t index) {
+      if (level == 0) {
+         auto it = leaves.find(index);
+         return it != leaves.end() ? leaf_hash(*it) : checksum256{};
+      }
+      auto it = nodes.find(node_id(level, index));
+      return it != nodes.end() ? it->hash : checksum256{};
+   }
+
+   /// @brief
+   /// Levels of stored nodes: leaf slots are allocated from 0, so every slot at or above
+   /// 2^depth is empty and tree nodes above 'depth' are (node, zero) pairs.
+   uint8_t occupied_depth(uint64_t leaves) {
+      uint8_t depth = 0;
+      while (depth < CommitmentDepth && (1ull << depth) < leaves) {
+         ++depth;
+      }
+      return depth;
+   }
+
+   /// @brief
+   /// Recompute nodes on path from leaf to root.
+   /// Reads and writes O(log(leaves)) nodes, levels above occupied depth are only hashed.
+   void update_path(name self, uint64_t index, checksum256 hash) {
+      rules_leaves_table_t leaves{self, Names::DefaultScope};
+      rules_nodes_table_t nodes{self, Names::DefaultScope};
+      rules_root_t root{self, Names::DefaultScope};
+      auto state = root.get_or_default();
+      const auto depth = occupied_depth(state.leaves);
+      static const checksum256 zero{};
+
+      for (uint8_t level = 0; level < CommitmentDepth; ++level) {
+         const auto sibling = level < depth ? get_node(leaves, nodes, level, index ^ 1) : zero;
+         hash = (index & 1) ? node_hash(sibling, hash) : node_hash(hash, sibling);
+         index >>= 1;
+         // Node at occupied depth is stored too, it becomes sibling once tree grows.
+         if (level + 1 > depth) {
+            continue;
+         }
+         // Zero nodes are not stored.
+         auto it = nodes.find(node_id(level + 1, index));
+         if (it == nodes.end()) {
+            if (hash != zero) {
+               nodes.emplace(self, [&](Tables::RuleNode& row) {
+                  row.id = node_id(level + 1, index);
+                  row.hash = hash;
+               });
+            }
+         } else if (hash == zero) {
+            nodes.erase(it);
+         } else {
+            nodes.modify(it, self, [&](Tables::RuleNode& row) {
+               row.hash = hash;
+            });
+         }
+      }
+
+      state.root = hash;
+      root.set(state, self);
+   }
+
+
+   /// @brief
+   /// Write rule value into its leaf, allocating leaf slot for new rule.
+   void commit_rule(name self, RuleKind kind, uint64_t a, uint64_t b, uint64_t c, bool value, uint32_t expires_at) {
+      rules_leaves_table_t leaves{self, Names::DefaultScope};
+      auto idx = leaves.get_index<Names::RulesLeavesIndex>();
+      const auto rule = make_rule_key(kind, a, b, c);
+      auto it = idx.find(rule);
+      uint64_t index = 0;
+      if (it == idx.end()) {
+         rules_root_t root{self, Names::DefaultScope};
+         auto state = root.get_or_default();
+         check(state.leaves < (1ull << CommitmentDepth), "500. Access rules commitment is full!");
+         index = state.leaves++;
+         root.set(state, self);
+         leaves.emplace(self, [&](Tables::RuleLeaf& row) {
+            row.id = index;
+            row.rule = rule;
+            row.value = value;
+            row.expires_at = expires_at;
+         });
+      } else {
+         if (it->value == value && it->expires_at == expires_at) {
+            return;
+         }
+         index = it->id;
+         idx.modify(it, self, [&](Tables::RuleLeaf& row) {
+            row.value = value;
+            row.expires_at = expires_at;
+         });
+      }
+      update_path(self, index, leaf_hash(*leaves.find(index)));
+   }
+
+   /// @brief
+   /// Clear leaf of removed rule.
+   void uncommit_rule(name self, RuleKind kind, uint64_t a, uint64_t b, uint64_t c) {
+      rules_leaves_table_t leaves{self, Names::DefaultScope};
+      auto idx = leaves.get_index<Names::RulesLeavesIndex>();
+      auto it = idx.find(make_rule_key(kind, a, b, c));
+      if (it == idx.end()) {
+         return;
+      }
+      const auto index = it->id;
+      idx.erase(it);
+      update_path(self, index, checksum256{});
+   }
+
+
+   RuleProof make_rule_proof(name self, RuleKind kind, uint64_t a, uint64_t b, uint64_t c) {
+      rules_leaves_table_t leaves{self, Names::DefaultScope};
+      rules_nodes_table_t nodes{self, Names::DefaultScope};
+      auto idx = leaves.get_index<Names::RulesLeavesIndex>();
+
+      RuleProof proof{};
+      proof.kind = static_cast<uint8_t>(kind);
+      auto it = idx.find(make_rule_key(kind, a, b, c));
+      if (it == idx.end()) {
+         return proof;
+      }
+      proof.found = true;
+      proof.index = it->id;
+      proof.value = it->value;
+      proof.expires_at = it->expires_at;
+      rules_root_t root{self, Names::DefaultScope};
+      const auto depth = occupied_depth(root.get_or_default().leaves);
+      proof.siblings.reserve(CommitmentDepth);
+      auto index = it->id;
+      for (uint8_t level = 0; level < CommitmentDepth; ++level, index >>= 1) {
+         proof.siblings.push_back(level < depth ? get_node(leaves, nodes, level, index ^ 1) : checksum256{});
+      }
+      return proof;
+   }
+
+
+   /// @brief
+   /// Access rules root with inclusion proofs of execution rules (read-only).
+   /// Enclave may verify cached decision offline against root of any later block,
+   /// while rules it depends on are not changed.
+   RulesProof RulesCommitment::sarproof(name enclave_owner, checksum256 script_hash, name grantee) {
+      RulesProof result{};
+      rules_root_t root{get_self(), Names::DefaultScope};
+      result.root = root.get_or_default().root;
+      result.complete = migrations::is_migrated(get_self(), Names::RulesLeavesTable);
+
+      const auto eo = enclave_owner.value;
+      result.rules.push_back(make_rule_proof(get_self(), RuleKind::Trust, eo, grantee.value, 0));
+
+      scripts::scripts_table_t scripts{get_self(), Names::DefaultScope};
+      auto sidx = scripts.get_index<Names::ScriptsHashIndex>();
+      auto sit = sidx.find(script_hash);
+      if (sit != sidx.end()) {
+         result.script_found = true;
+         result.script_id = sit->id;
+         result.script_owner = sit->owner;
+         result.rules.push_back(make_rule_proof(get_self(), RuleKind::Trust, eo, sit->owner.value, 0));
+         result.rules.push_back(make_rule_proof(get_self(), RuleKind::EnclaveAccess, eo, sit->id, grantee.value));
+         result.rules.push_back(make_rule_proof(get_self(), RuleKind::Grant, grantee.value, sit->id, 0));
+         result.rules.push_back(make_rule_proof(get_self(), RuleKind::Approve, eo, sit->id, 0));
+
+         // Permission not yet moved from 'encscraccess' is resolved by 'canexec', but it is not committed.
+         sar::enclave_access_table_t access{get_self(), eo};
+         auto aidx = access.get_index<Names::EnclaveAccessIndex>();
+         if (aidx.find(sar::Tables::EnclaveAccess::makeKey(sit->id, grantee)) == aidx.end()) {
+            sar::enclave_script_access_table_t esa{get_self(), eo};
+            auto eit = esa.find(sit->id);
+            result.complete = result.complete && (eit == esa.end() || eit->permissions.count(grantee) == 0);
+         }
+      }
+      print("Rules root:'", result.root, "' Complete:", result.complete, " Script found:", result.script_found);
+      return result;
+   }
+
+
+   /// @brief
+   /// Commit existing rules of providers starting from 'cursor', one stage per rules table:
+   /// trusts and approves of provider, grants to provider and permissions within provider enclave.
+   /// Returns number of committed rules.
+   uint64_t migrate_rules_commitment(name self, migrations::RowCursor& cursor, uint64_t limit) {
+      return migrations::migrate_provider_rows(self, cursor, 4, limit, [&](name provider, uint8_t stage, uint64_t& key, uint64_t rows) -> uint64_t {
+         const auto p = provider.value;
+         switch (stage) {
+         case 0: {
+            sar::trusted_providers_table_t trusted{self, p};
+            return migrations::migrate_rows(trusted, key, rows, [&](const auto& t) {
+               commit_rule(self, RuleKind::Trust, p, t.provider.value, 0, t.trust, 0);
+            });
+         }
+         case 1: {
+            sar::script_approves_table_t approves{self, p};
+            return migrations::migrate_rows(approves, key, rows, [&](const auto& a) {
+               commit_rule(self, RuleKind::Approve, p, a.script_id, 0, a.approved, 0);
+            });
+         }
+         case 2: {
+            sar::script_access_table_t access{self, p};
+            return migrations::migrate_rows(access, key, rows, [&](const auto& a) {
+               commit_rule(self, RuleKind::Grant, p, a.script_id, 0, a.granted, a.get_expires_at());
+            });
+         }
+         default: {
+            sar::enclave_access_table_t enclave_access{self, p};
+            return migrations::migrate_rows(enclave_access, key, rows, [&](const auto& a) {
+               commit_rule(self, RuleKind::EnclaveAccess, p, a.script_id, a.grantee.value, a.granted, a.get_expires_at());
+            });
+         }
+         }
+      });
+   }
+}
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "../common/Keys.hpp"
+#include "Migrations.hpp"
+#include "Names.hpp"
+#include <eosio/crypto.hpp>
+#include <eosio/eosio.hpp>
+#include <eosio/singleton.hpp>
+#include <libc/bits/stdint.h>
+#include <vector>
+
+namespace aggregion::commitment {
+
+   using eosio::name;
+
+   /// @brief
+   /// Depth of access rules Merkle tree (2^32 leaf slots).
+   /// Only nodes below occupied depth (ceil(log2(leaves))) are stored, upper nodes
+   /// pair with zero subtree and are hashed without table access.
+   static constexpr const uint8_t CommitmentDepth = 32;
+
+   /// @brief
+   /// Access rules committed to Merkle tree.
+   /// Rule key is Keys::pack(kind, a, b, c).
+   enum class RuleKind : uint8_t {
+      Trust,         ///< (truster, trustee)
+      Approve,       ///< (approver, script id)
+      Grant,         ///< (grantee, script id)
+      EnclaveAccess, ///< (enclave owner, script id, grantee)
+   };
+
+   struct Tables {
+
+      /// @brief
+      /// Committed access rule. Slot ('id') is allocated once per rule and never reused.
+      /// Leaf hash is Keys::hash(rule, Keys::pack(value, expires_at, 0)).
+      /// Scope: Default.
+      struct [[eosio::table, eosio::contract("Aggregion")]] RuleLeaf {
+         uint64_t id;
+         checksum256 rule;
+         bool value;
+         uint32_t expires_at;
+
+         auto primary_key() const {
+            return id;
+         }
+
+         checksum256 rule_key() const {
+            return rule;
+         }
+      };
+
+      /// @brief
+      /// Inner nodes of access rules tree with non-zero hash.
+      /// Id is (level << 32 | index), leaves are level 0.
+      /// Node of two zero children is zero, other nodes are Keys::hash(left, right).
+      /// Scope: Default.
+      struct [[eosio::table, eosio::contract("Aggregion")]] RuleNode {
+         uint64_t id;
+         checksum256 hash;
+
+         auto primary_key() const {
+            return id;
+         }
+      };
+
+      /// @brief
+      /// Access rules tree root and number of allocated leaf slots.
+      /// Scope: Default.
+      struct [[eosio::table, eosio::contract("Aggregion")]] RulesRoot {
+         checksum256 root;
+         uint64_t leaves = 0;
+      };
+   };
+
+   /// @brief
+   /// Inclusion proof of rule, 'siblings' are ordered from leaves to root.
+   /// Rule without leaf is not found and has no proof.
+   struct RuleProof {
+      uint8_t kind;
+      bool found;
+      uint64_t index;
+      bool value;
+      uint32_t expires_at;
+      std::vector<checksum256> siblings;
+   };
+
+   /// @brief
+   /// Access rules root with proofs of rules resolved by 'canexec':
+   /// enclave access, grantee access, owner approve, owner trusts grantee, owner trusts script owner.
+   /// 'complete' is false until existing rules are committed by 'migrate',
+   /// and while enclave access is resolved from 'encscraccess' row not yet moved by 'migrateesa'.
+   struct RulesProof {
+      checksum256 root;
+      bool complete;
+      bool script_found;
+      uint64_t script_id;
+      name script_owner;
+      std::vector<RuleProof> rules;
+   };
+
+   using rules_leaves_index_t = indexed_by<Names::RulesLeavesIndex, const_mem_fun<Tables::RuleLeaf, checksum256, &Tables::RuleLeaf::rule_key>>;
+   using rules_leaves_table_t = eosio::multi_index<Names::RulesLeavesTable, Tables::RuleLeaf, rules_leaves_index_t>;
+   using rules_nodes_table_t = eosio::multi_index<Names::RulesNodesTable, Tables::RuleNode>;
+   using rules_root_t = eosio::singleton<Names::RulesRootTable, Tables::RulesRoot>;
+
+   /// @brief
+   /// Aggregion access rules commitment.
+   struct [[eosio::contract("Aggregion")]] RulesCommitment : contract {
+      using contract::contract;
+
+      [[eosio::action]] RulesProof sarproof(name enclave_owner, checksum256 script_hash, name grantee);
+   };
+
+   /// Rule changes, each updates tree path of rule leaf.
+   void commit_rule(name self, RuleKind kind, uint64_t a, uint64_t b, uint64_t c, bool value, uint32_t expires_at);
+   void uncommit_rule(name self, RuleKind kind, uint64_t a, uint64_t b, uint64_t c);
+
+   uint64_t migrate_rules_commitment(name self, migrations::RowCursor& cursor, uint64_t limit);
+}
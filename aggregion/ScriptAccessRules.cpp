@@ -1,11 +1,245 @@
 #include "ScriptAccessRules.hpp"
+#include "Providers.hpp"
+#include "RulesCommitment.hpp"
 #include "Scripts.hpp"
 #include "Utility.hpp"
+#include <algorithm>
+#include <eosio/system.hpp>
 
 namespace aggregion {
 
    namespace sar {
 
+      void upsert_trusted_by(name self, name truster, name trustee, bool trust) {
+         trusted_by_table_t trusted_by{self, trustee.value};
+         auto it = trusted_by.find(truster.value);
+         if (it == trusted_by.end()) {
+            trusted_by.emplace(self, [&](Tables::TrustedBy& row) {
+               row.truster = truster;
+               row.trust = trust;
+            });
+         } else {
+            trusted_by.modify(it, self, [&](Tables::TrustedBy& row) {
+               row.trust = trust;
+            });
+         }
+      }
+
+      void erase_trusted_by(name self, name truster, name trustee) {
+         trusted_by_table_t trusted_by{self, trustee.value};
+         auto it = trusted_by.find(truster.value);
+         if (it != trusted_by.end()) {
+            trusted_by.erase(it);
+         }
+      }
+
+
+      void upsert_script_approver(name self, uint64_t script_id, name provider, bool approved) {
+         script_approvers_table_t approvers{self, script_id};
+         auto it = approvers.find(provider.value);
+         if (it == approvers.end()) {
+            approvers.emplace(self, [&](Tables::ScriptApprovers& row) {
+               row.provider = provider;
+               row.approved = approved;
+            });
+         } else {
+            approvers.modify(it, self, [&](Tables::ScriptApprovers& row) {
+               row.approved = approved;
+            });
+         }
+      }
+
+      void erase_script_approver(name self, uint64_t script_id, name provider) {
+         script_approvers_table_t approvers{self, script_id};
+         auto it = approvers.find(provider.value);
+         if (it != approvers.end()) {
+            approvers.erase(it);
+         }
+      }
+
+      void upsert_script_grantee(name self, uint64_t script_id, name grantee, bool granted) {
+         script_grantees_table_t grantees{self, script_id};
+         auto it = grantees.find(grantee.value);
+         if (it == grantees.end()) {
+            grantees.emplace(self, [&](Tables::ScriptGrantees& row) {
+               row.grantee = grantee;
+               row.granted = granted;
+            });
+         } else {
+            grantees.modify(it, self, [&](Tables::ScriptGrantees& row) {
+               row.granted = granted;
+            });
+         }
+      }
+
+      void erase_script_grantee(name self, uint64_t script_id, name grantee) {
+         script_grantees_table_t grantees{self, script_id};
+         auto it = grantees.find(grantee.value);
+         if (it != grantees.end()) {
+            grantees.erase(it);
+         }
+      }
+
+
+      uint32_t now_seconds() {
+         return eosio::current_time_point().sec_since_epoch();
+      }
+
+      /// @brief
+      /// Put grant into expiry queue or drop it from queue if 'expires_at' is zero.
+      void set_grant_expiry(name self, GrantKind kind, name scope, uint64_t key, uint32_t expires_at) {
+         grants_expiry_table_t expiry{self, Names::DefaultScope};
+         auto idx = expiry.get_index<Names::GrantsKeyIndex>();
+         auto it = idx.find(Tables::GrantExpiry::makeKey(kind, scope, key));
+         if (it == idx.end()) {
+            if (expires_at != 0) {
+               expiry.emplace(self, [&](Tables::GrantExpiry& row) {
+                  row.id = expiry.available_primary_key();
+                  row.kind = static_cast<uint8_t>(kind);
+                  row.scope = scope;
+                  row.key = key;
+                  row.expires_at = expires_at;
+               });
+            }
+         } else if (expires_at == 0) {
+            idx.erase(it);
+         } else {
+            idx.modify(it, self, [&](Tables::GrantExpiry& row) {
+               row.expires_at = expires_at;
+            });
+         }
+      }
+
+      void check_grant_expiry(bool granted, uint32_t expires_at) {
+         check(granted || expires_at == 0, "403. Expiry is allowed for granted access only!");
+         check(expires_at == 0 || expires_at > now_seconds(), "403. Grant expiry must be in the future!");
+      }
+
+
+      void add_trusted_approve(name self, name truster, uint64_t script_id, int64_t delta) {
+         trusted_approves_table_t counts{self, truster.value};
+         auto it = counts.find(script_id);
+         if (it == counts.end()) {
+            if (delta > 0) {
+               counts.emplace(self, [&](Tables::TrustedApproves& row) {
+                  row.script_id = script_id;
+                  row.count = delta;
+               });
+            }
+            return;
+         }
+         if (delta < 0 && it->count <= static_cast<uint64_t>(-delta)) {
+            counts.erase(it);
+            return;
+         }
+         counts.modify(it, self, [&](Tables::TrustedApproves& row) {
+            row.count += delta;
+         });
+      }
+
+      /// @brief
+      /// Queue change of counted trust or approve, see 'TrustUpdate'.
+      void queue_trust_update(name self, TrustUpdateKind kind, name provider, uint64_t subject, bool value) {
+         trust_updates_sequence_t sequence{self, Names::DefaultScope};
+         auto state = sequence.get_or_default();
+         trust_updates_table_t updates{self, Names::DefaultScope};
+         updates.emplace(self, [&](Tables::TrustUpdate& row) {
+            row.id = state.next_id;
+            row.kind = static_cast<uint8_t>(kind);
+            row.provider = provider;
+            row.subject = subject;
+            row.value = value;
+            row.key = 0;
+         });
+         ++state.next_id;
+         sequence.set(state, self);
+      }
+
+      uint64_t next_trust_update_id(name self) {
+         trust_updates_sequence_t sequence{self, Names::DefaultScope};
+         return sequence.get_or_default().next_id;
+      }
+
+      /// @brief
+      /// Walk counted 'table' from 'key' calling 'add' for every row while 'count' is below 'limit'.
+      /// Returns true when walk is done.
+      template <typename Table, typename Fn>
+      bool walk_counted(const Table& table, uint64_t& key, uint64_t limit, uint64_t& count, Fn&& add) {
+         auto it = table.lower_bound(key);
+         for (; it != table.end() && count < limit; ++it, ++count) {
+            key = it->primary_key() + 1;
+            add(*it);
+         }
+         return it == table.end();
+      }
+
+      /// @brief
+      /// Continue first queued update, returns true when it is done.
+      /// Update changing counted value walks counted rows of the other kind and changes that value once the walk is done.
+      bool apply_trust_update(name self, const Tables::TrustUpdate& update, uint64_t& key, uint64_t limit, uint64_t& count) {
+         const auto delta = update.value ? 1 : -1;
+         counted_trusts_table_t trusters{self, update.provider.value};
+         counted_approves_table_t approves{self, update.provider.value};
+         if (static_cast<TrustUpdateKind>(update.kind) == TrustUpdateKind::Trust) {
+            const auto truster = name{update.subject};
+            auto it = trusters.find(truster.value);
+            if ((it != trusters.end()) == update.value) {
+               return true;
+            }
+            if (!walk_counted(approves, key, limit, count, [&](const auto& a) { add_trusted_approve(self, truster, a.script_id, delta); })) {
+               return false;
+            }
+            if (update.value) {
+               trusters.emplace(self, [&](Tables::CountedTrust& row) {
+                  row.truster = truster;
+               });
+            } else {
+               trusters.erase(it);
+            }
+            return true;
+         }
+         const auto script_id = update.subject;
+         auto it = approves.find(script_id);
+         if ((it != approves.end()) == update.value) {
+            return true;
+         }
+         if (!walk_counted(trusters, key, limit, count, [&](const auto& t) { add_trusted_approve(self, t.truster, script_id, delta); })) {
+            return false;
+         }
+         if (update.value) {
+            approves.emplace(self, [&](Tables::CountedApprove& row) {
+               row.script_id = script_id;
+            });
+         } else {
+            approves.erase(it);
+         }
+         return true;
+      }
+
+      /// @brief
+      /// Apply queued updates with id below 'end' in queue order, walking at most 'limit' rows.
+      /// Done update is counted as a row too, so updates not changing counts are bounded as well.
+      /// One update is walked at a time, so it reads counted tables not changed by later updates.
+      /// Returns number of walked rows and done updates.
+      uint64_t apply_trust_updates(name self, uint64_t limit, uint64_t end) {
+         trust_updates_table_t updates{self, Names::DefaultScope};
+         uint64_t count = 0;
+         for (auto it = updates.begin(); it != updates.end() && it->id < end && count < limit;) {
+            auto key = it->key;
+            if (!apply_trust_update(self, *it, key, limit, count)) {
+               updates.modify(it, self, [&](Tables::TrustUpdate& row) {
+                  row.key = key;
+               });
+               break;
+            }
+            it = updates.erase(it);
+            // Update done by the last walked row doesn't exceed the limit.
+            count = std::min(count + 1, limit);
+         }
+         return count;
+      }
+
+
       void upsert_trust(name self, name truster, name trustee, bool trust) {
          require_auth(truster);
 
@@ -14,6 +248,7 @@ namespace aggregion {
 
          trusted_providers_table_t trusted{self, truster.value};
          auto it = trusted.find(trustee.value);
+         const bool was_trusted = it != trusted.end() && it->trust;
          if (it == trusted.end()) {
             trusted.emplace(self, [&](Tables::TrustedProviders& row) {
                row.provider = trustee;
@@ -24,6 +259,13 @@ namespace aggregion {
                row.trust = trust;
             });
          }
+         upsert_trusted_by(self, truster, trustee, trust);
+         commitment::commit_rule(self, commitment::RuleKind::Trust, truster.value, trustee.value, 0, trust, 0);
+         if (trust != was_trusted) {
+            add_provider_row_stat(self, truster, ProviderCounter::Trusts, trustee.value, trust ? 1 : -1);
+            queue_trust_update(self, TrustUpdateKind::Trust, trustee, truster.value, trust);
+         }
+         apply_trust_updates(self, TrustUpdatesBatchSize, AllTrustUpdates);
          print("Success. Truster:'", truster, "' Trustee:'", trustee, "' Trust:'", trust, "'");
       }
 
@@ -35,9 +277,11 @@ namespace aggregion {
 
          auto script_id = scripts::get_script_id(self, script_hash);
          check(script_id.has_value(), "404. Script not found by given hash");
+         check(!scripts::is_removing(self, script_id.value()), "403. Script is being removed!");
 
          script_approves_table_t approves{self, provider.value};
          auto it = approves.find(script_id.value());
+         const bool was_approved = it != approves.end() && it->approved;
          if (it == approves.end()) {
             approves.emplace(self, [&](Tables::ScriptApproves& row) {
                row.script_id = script_id.value();
@@ -49,62 +293,575 @@ namespace aggregion {
             });
          }
 
-         scripts::scripts_table_t scripts{self, Names::DefaultScope};
-         auto sit = scripts.require_find(script_id.value(), "500. Script not found");
-         scripts.modify(sit, self, [&](scripts::Tables::Scripts& row) {
-            row.approves_count += (approve ? 1 : -1);
-         });
+         upsert_script_approver(self, script_id.value(), provider, approve);
+         commitment::commit_rule(self, commitment::RuleKind::Approve, provider.value, script_id.value(), 0, approve, 0);
+         if (approve != was_approved) {
+            scripts::add_approves(self, script_id.value(), approve ? 1 : -1);
+            add_provider_row_stat(self, provider, ProviderCounter::Approves, script_id.value(), approve ? 1 : -1);
+            queue_trust_update(self, TrustUpdateKind::Approve, provider, script_id.value(), approve);
+         }
+         apply_trust_updates(self, TrustUpdatesBatchSize, AllTrustUpdates);
 
          print("Success. Provider:'", provider, "' Script hash:'", script_hash, "' Approved:'", approve, "'");
       }
 
 
-      void upsert_script_access(name self, name owner, checksum256 script_hash, name grantee, bool granted) {
-         require_auth(owner);
-
-         check(is_provider(self, grantee), "404. Provider (grantee) not found");
-
+      /// @brief
+      /// Resolve script id by hash and check it may be shared by 'owner'.
+      uint64_t get_owned_script_id(name self, name owner, checksum256 script_hash) {
          auto script_id = scripts::get_script_id(self, script_hash);
          check(script_id.has_value(), "404. Script not found by given hash");
 
          scripts::scripts_table_t scripts{self, Names::DefaultScope};
          auto sit = scripts.require_find(script_id.value(), "500. Script not found");
          check(sit->owner == owner, "403. Script owner mismatch");
+         check(!scripts::is_removing(self, script_id.value()), "403. Script is being removed!");
+         return script_id.value();
+      }
 
+      void apply_script_access(name self, uint64_t script_id, name grantee, bool granted, uint32_t expires_at) {
          script_access_table_t access{self, grantee.value};
-         auto it = access.find(script_id.value());
+         auto it = access.find(script_id);
+         const bool was_granted = it != access.end() && it->granted;
          if (it == access.end()) {
             access.emplace(self, [&](Tables::ScriptsAccess& row) {
-               row.script_id = script_id.value();
+               row.script_id = script_id;
                row.granted = granted;
+               row.expires_at.emplace(expires_at);
             });
          } else {
             access.modify(it, self, [&](Tables::ScriptsAccess& row) {
                row.granted = granted;
+               row.expires_at.emplace(expires_at);
+            });
+         }
+         set_grant_expiry(self, GrantKind::Script, grantee, script_id, expires_at);
+         upsert_script_grantee(self, script_id, grantee, granted);
+         commitment::commit_rule(self, commitment::RuleKind::Grant, grantee.value, script_id, 0, granted, expires_at);
+         if (granted != was_granted) {
+            add_provider_row_stat(self, grantee, ProviderCounter::Grants, script_id, granted ? 1 : -1);
+         }
+      }
+
+      void upsert_script_access(name self, name owner, checksum256 script_hash, name grantee, bool granted, uint32_t expires_at) {
+         require_auth(owner);
+         check_grant_expiry(granted, expires_at);
+
+         check(is_provider(self, grantee), "404. Provider (grantee) not found");
+         const auto script_id = get_owned_script_id(self, owner, script_hash);
+
+         apply_script_access(self, script_id, grantee, granted, expires_at);
+         print("Success. Owner:'", owner, "' Script hash:'", script_hash, "' Grant access:'", granted, "' Expires at:'", expires_at, "'");
+      }
+
+      std::optional<bool> get_enclave_access(name self, name enclave_owner, uint64_t script_id, name grantee, uint32_t current) {
+         enclave_access_table_t access{self, enclave_owner.value};
+         auto idx = access.get_index<Names::EnclaveAccessIndex>();
+         auto it = idx.find(Tables::EnclaveAccess::makeKey(script_id, grantee));
+         if (it != idx.end()) {
+            return it->is_granted(current);
+         }
+
+         enclave_script_access_table_t esa{self, enclave_owner.value};
+         auto eit = esa.find(script_id);
+         if (eit == esa.end()) {
+            return std::nullopt;
+         }
+         auto pit = eit->permissions.find(grantee);
+         if (pit == eit->permissions.end()) {
+            return std::nullopt;
+         }
+         return pit->second;
+      }
+
+
+      void add_script_enclave(name self, uint64_t script_id, name enclave_owner) {
+         script_enclaves_table_t enclaves{self, script_id};
+         if (enclaves.find(enclave_owner.value) == enclaves.end()) {
+            enclaves.emplace(self, [&](Tables::ScriptEnclaves& row) {
+               row.enclave_owner = enclave_owner;
+            });
+         }
+      }
+
+      /// @brief
+      /// Drop enclave owner from script mirror once its last permission for script is erased.
+      void release_script_enclave(name self, uint64_t script_id, name enclave_owner) {
+         enclave_access_table_t access{self, enclave_owner.value};
+         auto idx = access.get_index<Names::EnclaveAccessIndex>();
+         auto it = idx.lower_bound(Tables::EnclaveAccess::makeKey(script_id, name{}));
+         if (it != idx.end() && it->script_id == script_id) {
+            return;
+         }
+         script_enclaves_table_t enclaves{self, script_id};
+         auto eit = enclaves.find(enclave_owner.value);
+         if (eit != enclaves.end()) {
+            enclaves.erase(eit);
+         }
+      }
+
+
+      void upsert_enclave_access(name self, name enclave_owner, uint64_t script_id, name grantee, bool granted, uint32_t expires_at) {
+         enclave_access_table_t access{self, enclave_owner.value};
+         auto idx = access.get_index<Names::EnclaveAccessIndex>();
+         auto it = idx.find(Tables::EnclaveAccess::makeKey(script_id, grantee));
+         uint64_t id = 0;
+         if (it == idx.end()) {
+            id = access.available_primary_key();
+            access.emplace(self, [&](Tables::EnclaveAccess& row) {
+               row.id = id;
+               row.script_id = script_id;
+               row.grantee = grantee;
+               row.granted = granted;
+               row.expires_at.emplace(expires_at);
+            });
+            add_script_enclave(self, script_id, enclave_owner);
+         } else {
+            id = it->id;
+            idx.modify(it, self, [&](Tables::EnclaveAccess& row) {
+               row.granted = granted;
+               row.expires_at.emplace(expires_at);
             });
          }
-         print("Success. Owner:'", owner, "' Script hash:'", script_hash, "' Grant access:'", granted, "'");
+         set_grant_expiry(self, GrantKind::Enclave, enclave_owner, id, expires_at);
+         commitment::commit_rule(self, commitment::RuleKind::EnclaveAccess, enclave_owner.value, script_id, grantee.value, granted, expires_at);
       }
 
-      void ScriptAccessRules::encscraccess(std::string enclave_owner, checksum256 script_hash, std::string grantee, bool granted) {
+
+      /// @brief
+      /// Drop not yet migrated permissions of grantees, they are overridden by 'encaccess' rows.
+      void drop_legacy_enclave_access(name self, name enclave_owner, uint64_t script_id, const std::vector<name>& grantees) {
+         enclave_script_access_table_t esa{self, enclave_owner.value};
+         auto it = esa.find(script_id);
+         if (it == esa.end()) {
+            return;
+         }
+         auto permissions = it->permissions;
+         for (const auto& grantee : grantees) {
+            permissions.erase(grantee);
+         }
+         if (permissions.empty()) {
+            esa.erase(it);
+         } else if (permissions.size() != it->permissions.size()) {
+            esa.modify(it, self, [&](Tables::EnclaveScriptsAccess& row) {
+               row.permissions = std::move(permissions);
+            });
+         }
+      }
+
+
+      void ScriptAccessRules::encscraccess(std::string enclave_owner, checksum256 script_hash, std::string grantee, bool granted,
+                                           eosio::binary_extension<uint32_t> expires_at) {
          const auto eo = name{enclave_owner};
          const auto g = name{grantee};
+         const auto expiry = expires_at.has_value() ? expires_at.value() : 0;
          require_auth(eo);
+         check_grant_expiry(granted, expiry);
          auto script_id = scripts::get_script_id(get_self(), script_hash);
          check(script_id.has_value(), "404. Script not found by given hash");
+         check(!scripts::is_removing(get_self(), script_id.value()), "403. Script is being removed!");
+
+         upsert_enclave_access(get_self(), eo, script_id.value(), g, granted, expiry);
+         drop_legacy_enclave_access(get_self(), eo, script_id.value(), {g});
+         print("Success. Enclave owner:'", eo, "' Script hash:'", script_hash, "' Grant access:'", granted, "' to '", g, "'");
+      }
 
-         enclave_script_access_table_t esa{get_self(), eo.value};
-         auto it = esa.find(script_id.value());
 
-         if (it == esa.end()) {
-            it = esa.emplace(get_self(), [&](Tables::EnclaveScriptsAccess& row) {
-               row.script_id = script_id.value();
-            });
+      /// @brief
+      /// Grant (or deny) access to every script to every grantee.
+      /// Each script and each grantee is resolved once for the whole batch.
+      void ScriptAccessRules::grantmany(std::string owner, std::vector<checksum256> hashes, std::vector<name> grantees, bool granted,
+                                        eosio::binary_extension<uint32_t> expires_at) {
+         const auto o = name{owner};
+         const auto expiry = expires_at.has_value() ? expires_at.value() : 0;
+         require_auth(o);
+         check_grant_expiry(granted, expiry);
+         check(!hashes.empty() && !grantees.empty(), "403. Scripts and grantees are required!");
+         check(hashes.size() * grantees.size() <= MaxGrantsBatch, "403. Too many grants in batch!");
+
+         for (const auto& grantee : grantees) {
+            check(is_provider(get_self(), grantee), "404. Provider (grantee) not found");
+         }
+         std::vector<uint64_t> script_ids;
+         script_ids.reserve(hashes.size());
+         for (const auto& hash : hashes) {
+            script_ids.push_back(get_owned_script_id(get_self(), o, hash));
+         }
+
+         for (const auto script_id : script_ids) {
+            for (const auto& grantee : grantees) {
+               apply_script_access(get_self(), script_id, grantee, granted, expiry);
+            }
+         }
+         print("Success. Owner:'", o, "' Scripts:", script_ids.size(), " Grantees:", grantees.size(), " Grant access:'", granted, "' Expires at:'", expiry, "'");
+      }
+
+
+      /// @brief
+      /// Set access of every grantee to every script within enclave.
+      /// Each script is resolved once for the whole batch.
+      void ScriptAccessRules::encgrantmany(std::string enclave_owner, std::vector<checksum256> hashes, std::vector<name> grantees, bool granted,
+                                           eosio::binary_extension<uint32_t> expires_at) {
+         const auto eo = name{enclave_owner};
+         const auto expiry = expires_at.has_value() ? expires_at.value() : 0;
+         require_auth(eo);
+         check_grant_expiry(granted, expiry);
+         check(!hashes.empty() && !grantees.empty(), "403. Scripts and grantees are required!");
+         check(hashes.size() * grantees.size() <= MaxGrantsBatch, "403. Too many grants in batch!");
+
+         std::vector<uint64_t> script_ids;
+         script_ids.reserve(hashes.size());
+         for (const auto& hash : hashes) {
+            auto script_id = scripts::get_script_id(get_self(), hash);
+            check(script_id.has_value(), "404. Script not found by given hash");
+            check(!scripts::is_removing(get_self(), script_id.value()), "403. Script is being removed!");
+            script_ids.push_back(script_id.value());
+         }
+
+         for (const auto script_id : script_ids) {
+            for (const auto& grantee : grantees) {
+               upsert_enclave_access(get_self(), eo, script_id, grantee, granted, expiry);
+            }
+            drop_legacy_enclave_access(get_self(), eo, script_id, grantees);
+         }
+         print("Success. Enclave owner:'", eo, "' Scripts:", script_ids.size(), " Grantees:", grantees.size(), " Grant access:'", granted, "'");
+      }
+
+
+      /// @brief
+      /// Move at most 'max_rows' enclave permissions from deprecated 'encscraccess' rows into 'encaccess'.
+      void ScriptAccessRules::migrateesa(name enclave_owner, uint64_t max_rows) {
+         require_auth(get_self());
+         check(max_rows > 0, "403. Rows limit must be positive!");
+
+         enclave_script_access_table_t esa{get_self(), enclave_owner.value};
+         enclave_access_table_t access{get_self(), enclave_owner.value};
+         auto idx = access.get_index<Names::EnclaveAccessIndex>();
+         scripts::scripts_table_t scripts{get_self(), Names::DefaultScope};
+
+         uint64_t moved = 0;
+         auto it = esa.begin();
+         while (it != esa.end() && moved < max_rows) {
+            // Permissions of removed scripts are dropped.
+            const bool exists = scripts.find(it->script_id) != scripts.end() && !scripts::is_removing(get_self(), it->script_id);
+            std::vector<name> grantees;
+            for (const auto& [grantee, granted] : it->permissions) {
+               if (moved == max_rows)
+                  break;
+               // Permission written after upgrade has precedence.
+               if (exists && idx.find(Tables::EnclaveAccess::makeKey(it->script_id, grantee)) == idx.end()) {
+                  upsert_enclave_access(get_self(), enclave_owner, it->script_id, grantee, granted, 0);
+               }
+               grantees.push_back(grantee);
+               ++moved;
+            }
+
+            if (grantees.size() == it->permissions.size()) {
+               it = esa.erase(it);
+            } else {
+               esa.modify(it, get_self(), [&](Tables::EnclaveScriptsAccess& row) {
+                  for (const auto& grantee : grantees) {
+                     row.permissions.erase(grantee);
+                  }
+               });
+            }
+         }
+         print("Enclave owner:'", enclave_owner, "' Permissions migrated: ", moved, " Done: ", esa.begin() == esa.end());
+      }
+
+
+      /// @brief
+      /// Erase expired script access, unless it was changed after queue entry was written.
+      void expire_script_access(name self, name grantee, uint64_t script_id, uint32_t expires_at) {
+         script_access_table_t access{self, grantee.value};
+         auto it = access.find(script_id);
+         if (it == access.end() || it->get_expires_at() != expires_at) {
+            return;
+         }
+         if (it->granted) {
+            add_provider_row_stat(self, grantee, ProviderCounter::Grants, script_id, -1);
+         }
+         erase_script_grantee(self, script_id, grantee);
+         commitment::uncommit_rule(self, commitment::RuleKind::Grant, grantee.value, script_id, 0);
+         access.erase(it);
+      }
+
+      /// @brief
+      /// Erase expired enclave access, unless it was changed after queue entry was written.
+      void expire_enclave_access(name self, name enclave_owner, uint64_t id, uint32_t expires_at) {
+         enclave_access_table_t access{self, enclave_owner.value};
+         auto it = access.find(id);
+         if (it != access.end() && it->get_expires_at() == expires_at) {
+            const auto script_id = it->script_id;
+            commitment::uncommit_rule(self, commitment::RuleKind::EnclaveAccess, enclave_owner.value, script_id, it->grantee.value);
+            access.erase(it);
+            release_script_enclave(self, script_id, enclave_owner);
+         }
+      }
+
+
+      /// @brief
+      /// Erase at most 'max_rows' expired grants in expiry order.
+      /// Expired grants are already denied by checks, so anyone may reclaim their RAM.
+      void ScriptAccessRules::sweepgrants(uint64_t max_rows) {
+         check(max_rows > 0, "403. Rows limit must be positive!");
+         const auto current = now_seconds();
+
+         grants_expiry_table_t expiry{get_self(), Names::DefaultScope};
+         auto idx = expiry.get_index<Names::GrantsExpiryIndex>();
+         uint64_t count = 0;
+         auto it = idx.begin();
+         for (; it != idx.end() && it->expires_at <= current && count < max_rows; ++count) {
+            if (static_cast<GrantKind>(it->kind) == GrantKind::Script) {
+               expire_script_access(get_self(), it->scope, it->key, it->expires_at);
+            } else {
+               expire_enclave_access(get_self(), it->scope, it->key, it->expires_at);
+            }
+            it = idx.erase(it);
          }
-         esa.modify(it, get_self(), [&](Tables::EnclaveScriptsAccess& row) {
-            row.permissions[g] = granted;
+         print("Expired grants removed: ", count, " Done: ", it == idx.end() || it->expires_at > current);
+      }
+
+
+      /// @brief
+      /// Apply queued trust updates walking at most 'max_rows' rows.
+      /// Trust and approve actions apply a bounded batch themselves, so anyone may drain the rest.
+      void ScriptAccessRules::synctrust(uint64_t max_rows) {
+         check(max_rows > 0, "403. Rows limit must be positive!");
+         const auto count = apply_trust_updates(get_self(), max_rows, AllTrustUpdates);
+         trust_updates_table_t updates{get_self(), Names::DefaultScope};
+         print("Trust updates rows applied: ", count, " Done: ", updates.begin() == updates.end());
+      }
+
+
+      /// @brief
+      /// Mirror trust statements of providers starting from 'cursor' into 'trustedby'.
+      /// Returns number of visited trust statements.
+      uint64_t migrate_trusted_by(name self, migrations::RowCursor& cursor, uint64_t limit) {
+         return migrations::migrate_provider_rows(self, cursor, 1, limit, [&](name truster, uint8_t, uint64_t& key, uint64_t rows) {
+            trusted_providers_table_t trusted{self, truster.value};
+            return migrations::migrate_rows(trusted, key, rows, [&](const auto& t) {
+               upsert_trusted_by(self, truster, t.provider, t.trust);
+            });
          });
-         print("Success. Enclave owner:'", eo, "' Script hash:'", script_hash, "' Grant access:'", granted, "' to '", g, "'");
+      }
+
+
+      /// @brief
+      /// Mirror approves of providers starting from 'cursor' into 'scrapprovers'.
+      /// Returns number of visited approves.
+      uint64_t migrate_script_approvers(name self, migrations::RowCursor& cursor, uint64_t limit) {
+         return migrations::migrate_provider_rows(self, cursor, 1, limit, [&](name provider, uint8_t, uint64_t& key, uint64_t rows) {
+            script_approves_table_t approves{self, provider.value};
+            return migrations::migrate_rows(approves, key, rows, [&](const auto& a) {
+               upsert_script_approver(self, a.script_id, provider, a.approved);
+            });
+         });
+      }
+
+      /// @brief
+      /// Mirror script accesses of providers starting from 'cursor' into 'scrgrantees'.
+      /// Returns number of visited accesses.
+      uint64_t migrate_script_grantees(name self, migrations::RowCursor& cursor, uint64_t limit) {
+         return migrations::migrate_provider_rows(self, cursor, 1, limit, [&](name grantee, uint8_t, uint64_t& key, uint64_t rows) {
+            script_access_table_t access{self, grantee.value};
+            return migrations::migrate_rows(access, key, rows, [&](const auto& a) {
+               upsert_script_grantee(self, a.script_id, grantee, a.granted);
+            });
+         });
+      }
+
+
+      /// @brief
+      /// Queue existing trusts and approves of providers starting from 'cursor', one stage per table.
+      /// Updates set counted values, so rows changed meanwhile or queued twice are not counted twice.
+      /// Counts are complete once queued updates are applied by 'synctrust'.
+      /// Returns number of visited trust statements and approves.
+      uint64_t migrate_trusted_approves(name self, migrations::RowCursor& cursor, uint64_t limit) {
+         return migrations::migrate_provider_rows(self, cursor, 2, limit, [&](name provider, uint8_t stage, uint64_t& key, uint64_t rows) {
+            if (stage == 0) {
+               trusted_providers_table_t trusted{self, provider.value};
+               return migrations::migrate_rows(trusted, key, rows, [&](const auto& t) {
+                  if (t.trust) {
+                     queue_trust_update(self, TrustUpdateKind::Trust, t.provider, provider.value, true);
+                  }
+               });
+            }
+            script_approves_table_t approves{self, provider.value};
+            return migrations::migrate_rows(approves, key, rows, [&](const auto& a) {
+               if (a.approved) {
+                  queue_trust_update(self, TrustUpdateKind::Approve, provider, a.script_id, true);
+               }
+            });
+         });
+      }
+
+
+      /// @brief
+      /// Erase at most 'limit' approves, accesses and enclave permissions of removed script.
+      /// Returns number of erased rules.
+      uint64_t remove_script_rules(name self, uint64_t script_id, uint64_t limit) {
+         uint64_t count = 0;
+         script_approvers_table_t approvers{self, script_id};
+         for (auto it = approvers.begin(); it != approvers.end() && count < limit; ++count) {
+            script_approves_table_t approves{self, it->provider.value};
+            auto ait = approves.find(script_id);
+            if (ait != approves.end()) {
+               if (ait->approved) {
+                  add_provider_row_stat(self, it->provider, ProviderCounter::Approves, script_id, -1);
+                  queue_trust_update(self, TrustUpdateKind::Approve, it->provider, script_id, false);
+               }
+               commitment::uncommit_rule(self, commitment::RuleKind::Approve, it->provider.value, script_id, 0);
+               approves.erase(ait);
+            }
+            it = approvers.erase(it);
+         }
+
+         script_grantees_table_t grantees{self, script_id};
+         for (auto it = grantees.begin(); it != grantees.end() && count < limit; ++count) {
+            script_access_table_t access{self, it->grantee.value};
+            auto ait = access.find(script_id);
+            if (ait != access.end()) {
+               if (ait->granted) {
+                  add_provider_row_stat(self, it->grantee, ProviderCounter::Grants, script_id, -1);
+               }
+               if (ait->get_expires_at() != 0) {
+                  set_grant_expiry(self, GrantKind::Script, it->grantee, script_id, 0);
+               }
+               commitment::uncommit_rule(self, commitment::RuleKind::Grant, it->grantee.value, script_id, 0);
+               access.erase(ait);
+            }
+            it = grantees.erase(it);
+         }
+
+         script_enclaves_table_t enclaves{self, script_id};
+         for (auto eit = enclaves.begin(); eit != enclaves.end() && count < limit;) {
+            const auto enclave_owner = eit->enclave_owner;
+            enclave_access_table_t access{self, enclave_owner.value};
+            auto idx = access.get_index<Names::EnclaveAccessIndex>();
+            auto it = idx.lower_bound(Tables::EnclaveAccess::makeKey(script_id, name{}));
+            for (; it != idx.end() && it->script_id == script_id && count < limit; ++count) {
+               if (it->get_expires_at() != 0) {
+                  set_grant_expiry(self, GrantKind::Enclave, enclave_owner, it->id, 0);
+               }
+               commitment::uncommit_rule(self, commitment::RuleKind::EnclaveAccess, enclave_owner.value, script_id, it->grantee.value);
+               it = idx.erase(it);
+            }
+            if (it == idx.end() || it->script_id != script_id) {
+               eit = enclaves.erase(eit);
+            }
+         }
+         return count;
+      }
+
+
+      bool is_trusted(name self, name truster, name trustee) {
+         trusted_providers_table_t trusted{self, truster.value};
+         auto it = trusted.find(trustee.value);
+         return it != trusted.end() && it->trust;
+      }
+
+
+      /// @brief
+      /// Resolve all execution rules of script within enclave (read-only).
+      ExecutionVerdict ScriptAccessRules::canexec(name enclave_owner, checksum256 script_hash, name grantee) {
+         ExecutionVerdict verdict{};
+         const auto current = now_seconds();
+         verdict.owner_trusts_grantee = is_trusted(get_self(), enclave_owner, grantee);
+
+         scripts::scripts_table_t scripts{get_self(), Names::DefaultScope};
+         auto idx = scripts.get_index<Names::ScriptsHashIndex>();
+         auto sit = idx.find(script_hash);
+         if (sit == idx.end()) {
+            print("Script not found. Hash:'", script_hash, "'");
+            return verdict;
+         }
+         verdict.script_found = true;
+         verdict.script_id = sit->id;
+         verdict.script_owner = sit->owner;
+         verdict.owner_trusts_script_owner = is_trusted(get_self(), enclave_owner, sit->owner);
+
+         verdict.enclave_access = get_enclave_access(get_self(), enclave_owner, sit->id, grantee, current);
+
+         script_access_table_t access{get_self(), grantee.value};
+         auto ait = access.find(sit->id);
+         if (ait != access.end()) {
+            verdict.grantee_access = ait->is_granted(current);
+         }
+
+         script_approves_table_t approves{get_self(), enclave_owner.value};
+         auto apit = approves.find(sit->id);
+         if (apit != approves.end()) {
+            verdict.owner_approved = apit->approved;
+         }
+
+         trusted_approves_table_t trusted_approves{get_self(), enclave_owner.value};
+         auto tait = trusted_approves.find(sit->id);
+         if (tait != trusted_approves.end()) {
+            verdict.trusted_approves = tait->count;
+         }
+
+         print("Script id:", verdict.script_id, " Enclave access:", verdict.enclave_access.value_or(false), " Grantee access:", verdict.grantee_access.value_or(false),
+               " Approved:", verdict.owner_approved.value_or(false));
+         return verdict;
+      }
+
+
+      /// @brief
+      /// Whole enclave permissions matrix as bitsets (read-only).
+      /// Permissions not yet moved by 'migrateesa' are included, 'encaccess' rows take precedence.
+      EnclaveSnapshot ScriptAccessRules::encsnapshot(name enclave_owner) {
+         struct Permission {
+            uint64_t script_id;
+            name grantee;
+            bool granted;
+            uint32_t expires_at;
+         };
+         std::vector<Permission> permissions;
+
+         enclave_access_table_t access{get_self(), enclave_owner.value};
+         auto idx = access.get_index<Names::EnclaveAccessIndex>();
+         for (const auto& a : access) {
+            permissions.push_back({a.script_id, a.grantee, a.granted, a.get_expires_at()});
+         }
+         enclave_script_access_table_t esa{get_self(), enclave_owner.value};
+         for (const auto& row : esa) {
+            for (const auto& [grantee, granted] : row.permissions) {
+               if (idx.find(Tables::EnclaveAccess::makeKey(row.script_id, grantee)) == idx.end()) {
+                  permissions.push_back({row.script_id, grantee, granted, 0});
+               }
+            }
+         }
+
+         EnclaveSnapshot snapshot{};
+         snapshot.time = now_seconds();
+         for (const auto& p : permissions) {
+            snapshot.scripts.push_back(p.script_id);
+            snapshot.grantees.push_back(p.grantee);
+         }
+         std::sort(snapshot.scripts.begin(), snapshot.scripts.end());
+         snapshot.scripts.erase(std::unique(snapshot.scripts.begin(), snapshot.scripts.end()), snapshot.scripts.end());
+         std::sort(snapshot.grantees.begin(), snapshot.grantees.end());
+         snapshot.grantees.erase(std::unique(snapshot.grantees.begin(), snapshot.grantees.end()), snapshot.grantees.end());
+
+         const auto bits = snapshot.scripts.size() * snapshot.grantees.size();
+         snapshot.known.resize((bits + 7) / 8);
+         snapshot.granted.resize((bits + 7) / 8);
+         for (const auto& p : permissions) {
+            const auto s = std::lower_bound(snapshot.scripts.begin(), snapshot.scripts.end(), p.script_id) - snapshot.scripts.begin();
+            const auto g = std::lower_bound(snapshot.grantees.begin(), snapshot.grantees.end(), p.grantee) - snapshot.grantees.begin();
+            const auto bit = s * snapshot.grantees.size() + g;
+            snapshot.known[bit / 8] |= 1 << (bit % 8);
+            const bool expired = p.expires_at != 0 && snapshot.time >= p.expires_at;
+            if (p.granted && !expired) {
+               snapshot.granted[bit / 8] |= 1 << (bit % 8);
+               if (p.expires_at != 0 && (snapshot.valid_until == 0 || p.expires_at < snapshot.valid_until)) {
+                  snapshot.valid_until = p.expires_at;
+               }
+            }
+         }
+         print("Enclave owner:'", enclave_owner, "' Scripts: ", snapshot.scripts.size(), " Grantees: ", snapshot.grantees.size());
+         return snapshot;
       }
 
 
@@ -124,54 +881,100 @@ namespace aggregion {
          upsert_execution_approve(get_self(), name{provider}, hash, false);
       }
 
-      void ScriptAccessRules::grantaccess(std::string owner, checksum256 hash, std::string grantee) {
-         upsert_script_access(get_self(), name{owner}, hash, name{grantee}, true);
+      void ScriptAccessRules::grantaccess(std::string owner, checksum256 hash, std::string grantee, eosio::binary_extension<uint32_t> expires_at) {
+         upsert_script_access(get_self(), name{owner}, hash, name{grantee}, true, expires_at.has_value() ? expires_at.value() : 0);
       }
 
       void ScriptAccessRules::denyaccess(std::string owner, checksum256 hash, std::string grantee) {
-         upsert_script_access(get_self(), name{owner}, hash, name{grantee}, false);
+         upsert_script_access(get_self(), name{owner}, hash, name{grantee}, false, 0);
       }
 
    }
 
-   void remove_provider_trusts(name self, name provider) {
+   uint64_t remove_provider_trusts(name self, name provider, uint64_t limit) {
       sar::trusted_providers_table_t trusted{self, provider.value};
-      while (true) {
-         auto it = trusted.begin();
-         if (it == trusted.end())
-            break;
-         trusted.erase(it);
+      uint64_t count = 0;
+      for (auto it = trusted.begin(); it != trusted.end() && count < limit; ++count) {
+         if (it->trust) {
+            add_provider_row_stat(self, provider, ProviderCounter::Trusts, it->provider.value, -1);
+            sar::queue_trust_update(self, sar::TrustUpdateKind::Trust, it->provider, provider.value, false);
+         }
+         sar::erase_trusted_by(self, provider, it->provider);
+         commitment::uncommit_rule(self, commitment::RuleKind::Trust, provider.value, it->provider.value, 0);
+         it = trusted.erase(it);
+      }
+      return count;
+   }
+
+   uint64_t remove_provider_inbound_trusts(name self, name provider, uint64_t limit) {
+      sar::trusted_by_table_t trusted_by{self, provider.value};
+      uint64_t count = 0;
+      for (auto it = trusted_by.begin(); it != trusted_by.end() && count < limit; ++count) {
+         sar::trusted_providers_table_t trusted{self, it->truster.value};
+         auto tit = trusted.find(provider.value);
+         if (tit != trusted.end()) {
+            if (tit->trust) {
+               add_provider_row_stat(self, it->truster, ProviderCounter::Trusts, provider.value, -1);
+               sar::queue_trust_update(self, sar::TrustUpdateKind::Trust, provider, it->truster.value, false);
+            }
+            commitment::uncommit_rule(self, commitment::RuleKind::Trust, it->truster.value, provider.value, 0);
+            trusted.erase(tit);
+         }
+         it = trusted_by.erase(it);
       }
+      return count;
    }
 
-   void remove_provider_approves(name self, name provider) {
+   uint64_t remove_provider_approves(name self, name provider, uint64_t limit) {
       sar::script_approves_table_t approves{self, provider.value};
-      while (true) {
-         auto it = approves.begin();
-         if (it == approves.end())
-            break;
-         approves.erase(it);
+      uint64_t count = 0;
+      for (auto it = approves.begin(); it != approves.end() && count < limit; ++count) {
+         if (it->approved) {
+            scripts::add_approves(self, it->script_id, -1);
+            sar::queue_trust_update(self, sar::TrustUpdateKind::Approve, provider, it->script_id, false);
+            add_provider_row_stat(self, provider, ProviderCounter::Approves, it->script_id, -1);
+         }
+         sar::erase_script_approver(self, it->script_id, provider);
+         commitment::uncommit_rule(self, commitment::RuleKind::Approve, provider.value, it->script_id, 0);
+         it = approves.erase(it);
       }
+      return count;
    }
 
-   void remove_provider_accesses(name self, name provider) {
+   uint64_t remove_provider_accesses(name self, name provider, uint64_t limit) {
       sar::script_access_table_t access{self, provider.value};
-      while (true) {
-         auto it = access.begin();
-         if (it == access.end())
-            break;
-         access.erase(it);
+      uint64_t count = 0;
+      for (auto it = access.begin(); it != access.end() && count < limit; ++count) {
+         if (it->granted) {
+            add_provider_row_stat(self, provider, ProviderCounter::Grants, it->script_id, -1);
+         }
+         if (it->get_expires_at() != 0) {
+            sar::set_grant_expiry(self, sar::GrantKind::Script, provider, it->script_id, 0);
+         }
+         sar::erase_script_grantee(self, it->script_id, provider);
+         commitment::uncommit_rule(self, commitment::RuleKind::Grant, provider.value, it->script_id, 0);
+         it = access.erase(it);
       }
+      return count;
    }
 
-   void remove_provider_enclave_accesses(name self, name provider) {
+   uint64_t remove_provider_enclave_accesses(name self, name provider, uint64_t limit) {
+      sar::enclave_access_table_t access{self, provider.value};
+      uint64_t count = 0;
+      for (auto it = access.begin(); it != access.end() && count < limit; ++count) {
+         if (it->get_expires_at() != 0) {
+            sar::set_grant_expiry(self, sar::GrantKind::Enclave, provider, it->id, 0);
+         }
+         const auto script_id = it->script_id;
+         commitment::uncommit_rule(self, commitment::RuleKind::EnclaveAccess, provider.value, script_id, it->grantee.value);
+         it = access.erase(it);
+         sar::release_script_enclave(self, script_id, provider);
+      }
       sar::enclave_script_access_table_t esa{self, provider.value};
-      while (true) {
-         auto it = esa.begin();
-         if (it == esa.end())
-            break;
-         esa.erase(it);
+      for (auto it = esa.begin(); it != esa.end() && count < limit; ++count) {
+         it = esa.erase(it);
       }
+      return count;
    }
 
 }
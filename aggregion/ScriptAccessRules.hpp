@@ -1,15 +1,49 @@
 #pragma once
 
+#include "../common/Keys.hpp"
+#include "Migrations.hpp"
 #include "Names.hpp"
+#include <eosio/binary_extension.hpp>
 #include <eosio/crypto.hpp>
 #include <eosio/eosio.hpp>
+#include <eosio/singleton.hpp>
 #include <libc/bits/stdint.h>
+#include <limits>
 #include <map>
+#include <optional>
 
 namespace aggregion::sar {
 
    using eosio::name;
 
+   /// @brief
+   /// Queued trust updates rows applied by 'trust', 'untrust', 'execapprove' and 'execdeny' themselves,
+   /// the rest is applied by 'synctrust'.
+   static constexpr const uint64_t TrustUpdatesBatchSize = 100;
+
+   /// @brief
+   /// Queue position after every queued trust update.
+   static constexpr const uint64_t AllTrustUpdates = std::numeric_limits<uint64_t>::max();
+
+   /// @brief
+   /// Changes of 'trustapprvs' counts.
+   enum class TrustUpdateKind : uint8_t {
+      Trust,   ///< truster trusts provider, counts of provider approves are walked
+      Approve, ///< provider approves script, counts of provider trusters are walked
+   };
+
+   /// @brief
+   /// Grants (script and grantee pairs) set by one 'grantmany' or 'encgrantmany' call,
+   /// each one updates rules tree path of O(log(rules)) nodes.
+   static constexpr const uint64_t MaxGrantsBatch = 500;
+
+   /// @brief
+   /// Time-bounded grant tables.
+   enum class GrantKind : uint8_t {
+      Script,  ///< 'scriptaccess' row, key is script id
+      Enclave, ///< 'encaccess' row, key is row id
+   };
+
    namespace Tables {
       /// @brief
       /// Trusted providers.
@@ -22,6 +56,76 @@ namespace aggregion::sar {
          }
       };
 
+      /// @brief
+      /// Mirror of 'TrustedProviders' scoped by trustee.
+      /// Scope: Provider (trustee).
+      struct [[eosio::table, eosio::contract("Aggregion")]] TrustedBy {
+         name truster;
+         bool trust;
+         auto primary_key() const {
+            return truster.value;
+         }
+      };
+
+      /// @brief
+      /// Number of script approves made by providers trusted by truster.
+      /// Rows with zero count are erased.
+      /// Scope: Provider (truster).
+      struct [[eosio::table, eosio::contract("Aggregion")]] TrustedApproves {
+         uint64_t script_id;
+         uint64_t count;
+         auto primary_key() const {
+            return script_id;
+         }
+      };
+
+      /// @brief
+      /// Trusters of provider counted in 'TrustedApproves'.
+      /// Changed by applied trust updates only, so it lags behind 'TrustedBy' while updates are queued.
+      /// Scope: Provider (trustee).
+      struct [[eosio::table, eosio::contract("Aggregion")]] CountedTrust {
+         name truster;
+         auto primary_key() const {
+            return truster.value;
+         }
+      };
+
+      /// @brief
+      /// Scripts approved by provider counted in 'TrustedApproves'.
+      /// Changed by applied trust updates only, so it lags behind 'ScriptApproves' while updates are queued.
+      /// Scope: Provider (approver).
+      struct [[eosio::table, eosio::contract("Aggregion")]] CountedApprove {
+         uint64_t script_id;
+         auto primary_key() const {
+            return script_id;
+         }
+      };
+
+      /// @brief
+      /// Queue of trust and approve changes not applied to 'TrustedApproves' yet, applied in 'id' order.
+      /// Update sets counted trust ('subject' is truster) or approve ('subject' is script id) of 'provider' to 'value',
+      /// walking counted approves or trusters of 'provider' from 'key' when counted value changes.
+      /// Scope: Default.
+      struct [[eosio::table, eosio::contract("Aggregion")]] TrustUpdate {
+         uint64_t id;
+         uint8_t kind;
+         name provider;
+         uint64_t subject;
+         bool value;
+         uint64_t key;
+
+         auto primary_key() const {
+            return id;
+         }
+      };
+
+      /// @brief
+      /// Next trust update id, ids are not reused when queue is drained.
+      /// Scope: Default.
+      struct [[eosio::table, eosio::contract("Aggregion")]] TrustUpdatesSequence {
+         uint64_t next_id = 0;
+      };
+
       /// @brief
       /// Provider execution approves.
       /// Scope: Provider (approver).
@@ -35,19 +139,52 @@ namespace aggregion::sar {
 
       /// @brief
       /// Script access permission.
+      /// Grant with non-zero 'expires_at' (seconds since epoch) is denied since that time.
       /// Scope: Provider (grantee).
       struct [[eosio::table, eosio::contract("Aggregion")]] ScriptsAccess {
          uint64_t script_id;
          bool granted;
+         eosio::binary_extension<uint32_t> expires_at;
          auto primary_key() const {
             return script_id;
          }
+
+         uint32_t get_expires_at() const {
+            return expires_at.has_value() ? expires_at.value() : 0;
+         }
+
+         bool is_granted(uint32_t now) const {
+            return granted && (get_expires_at() == 0 || now < get_expires_at());
+         }
+      };
+
+      /// @brief
+      /// Mirror of 'ScriptApproves' scoped by script.
+      /// Scope: Script id.
+      struct [[eosio::table, eosio::contract("Aggregion")]] ScriptApprovers {
+         name provider;
+         bool approved;
+         auto primary_key() const {
+            return provider.value;
+         }
+      };
+
+      /// @brief
+      /// Mirror of 'ScriptsAccess' scoped by script.
+      /// Scope: Script id.
+      struct [[eosio::table, eosio::contract("Aggregion")]] ScriptGrantees {
+         name grantee;
+         bool granted;
+         auto primary_key() const {
+            return grantee.value;
+         }
       };
 
       /// @brief
       /// Provider (grantee) access to script within given enclave.
       /// Scope: Provider (enclave owner, grantor).
       /// (Script owner is ignored here)
+      /// Deprecated: rows are moved to 'EnclaveAccess' by 'migrateesa'.
       struct [[eosio::table, eosio::contract("Aggregion")]] EnclaveScriptsAccess {
          uint64_t script_id;
          std::map<name, bool> permissions;
@@ -55,12 +192,131 @@ namespace aggregion::sar {
             return script_id;
          }
       };
+
+      /// @brief
+      /// Provider (grantee) access to script within given enclave. One row per grantee.
+      /// Scope: Provider (enclave owner, grantor).
+      struct [[eosio::table, eosio::contract("Aggregion")]] EnclaveAccess {
+         uint64_t id;
+         uint64_t script_id;
+         name grantee;
+         bool granted;
+         eosio::binary_extension<uint32_t> expires_at;
+
+         auto primary_key() const {
+            return id;
+         }
+
+         uint32_t get_expires_at() const {
+            return expires_at.has_value() ? expires_at.value() : 0;
+         }
+
+         bool is_granted(uint32_t now) const {
+            return granted && (get_expires_at() == 0 || now < get_expires_at());
+         }
+
+         static auto makeKey(uint64_t script_id, name grantee) {
+            return (static_cast<uint128_t>(script_id) << 64) | grantee.value;
+         }
+
+         uint128_t key() const {
+            return makeKey(script_id, grantee);
+         }
+      };
+
+      /// @brief
+      /// Enclave owners having 'EnclaveAccess' rows for script, so script removal finds them.
+      /// Scope: Script id.
+      struct [[eosio::table, eosio::contract("Aggregion")]] ScriptEnclaves {
+         name enclave_owner;
+         auto primary_key() const {
+            return enclave_owner.value;
+         }
+      };
+
+      /// @brief
+      /// Expiry queue of time-bounded grants, drained by 'sweepgrants'.
+      /// Entry is replaced when grant expiry changes and erased with the grant.
+      /// Scope: Default.
+      struct [[eosio::table, eosio::contract("Aggregion")]] GrantExpiry {
+         uint64_t id;
+         uint8_t kind;
+         name scope;
+         uint64_t key;
+         uint32_t expires_at;
+
+         auto primary_key() const {
+            return id;
+         }
+
+         uint64_t by_expiry() const {
+            return expires_at;
+         }
+
+         static checksum256 makeKey(GrantKind kind, name scope, uint64_t key) {
+            return common::Keys::pack(static_cast<uint64_t>(kind), scope.value, key);
+         }
+
+         checksum256 grant_key() const {
+            return makeKey(static_cast<GrantKind>(kind), scope, key);
+         }
+      };
+   };
+
+   /// @brief
+   /// Script execution rules resolved within enclave.
+   /// Unset rule means there is no record for it.
+   ///   enclave_access - enclave owner allows grantee to run script within enclave;
+   ///   grantee_access - script owner grants grantee access to script;
+   ///   (expired grants are reported as denied)
+   ///   owner_approved - enclave owner approves script execution;
+   ///   trusted_approves - number of approves by providers trusted by enclave owner,
+   ///   trust and approve changes still queued for 'synctrust' are not counted yet.
+   struct ExecutionVerdict {
+      bool script_found;
+      uint64_t script_id;
+      name script_owner;
+      std::optional<bool> enclave_access;
+      std::optional<bool> grantee_access;
+      std::optional<bool> owner_approved;
+      bool owner_trusts_grantee;
+      bool owner_trusts_script_owner;
+      uint64_t trusted_approves;
+   };
+
+   /// @brief
+   /// Enclave permissions matrix.
+   /// 'scripts' and 'grantees' are sorted and map ids to dense indices,
+   /// bit (script index * grantees count + grantee index) of 'known' is set if permission exists,
+   /// the same bit of 'granted' is set if access is granted and not expired at 'time' (least significant bit first).
+   /// 'valid_until' is the earliest expiry of granted permissions, 0 if none expires.
+   struct EnclaveSnapshot {
+      uint32_t time;
+      uint32_t valid_until;
+      std::vector<uint64_t> scripts;
+      std::vector<name> grantees;
+      std::vector<uint8_t> known;
+      std::vector<uint8_t> granted;
    };
 
    using trusted_providers_table_t = eosio::multi_index<Names::TrustedProvidersTable, Tables::TrustedProviders>;
+   using trusted_by_table_t = eosio::multi_index<Names::TrustedByTable, Tables::TrustedBy>;
+   using trusted_approves_table_t = eosio::multi_index<Names::TrustedApprovesTable, Tables::TrustedApproves>;
+   using counted_trusts_table_t = eosio::multi_index<Names::CountedTrustsTable, Tables::CountedTrust>;
+   using counted_approves_table_t = eosio::multi_index<Names::CountedApprovesTable, Tables::CountedApprove>;
+   using trust_updates_table_t = eosio::multi_index<Names::TrustUpdatesTable, Tables::TrustUpdate>;
+   using trust_updates_sequence_t = eosio::singleton<Names::TrustUpdatesSequenceTable, Tables::TrustUpdatesSequence>;
    using script_approves_table_t = eosio::multi_index<Names::ScriptApprovesTable, Tables::ScriptApproves>;
    using script_access_table_t = eosio::multi_index<Names::ScriptAccessTable, Tables::ScriptsAccess>;
+   using script_approvers_table_t = eosio::multi_index<Names::ScriptApproversTable, Tables::ScriptApprovers>;
+   using script_grantees_table_t = eosio::multi_index<Names::ScriptGranteesTable, Tables::ScriptGrantees>;
    using enclave_script_access_table_t = eosio::multi_index<Names::EnclaveScriptAccessTable, Tables::EnclaveScriptsAccess>;
+   using enclave_access_index_t = indexed_by<Names::EnclaveAccessIndex, const_mem_fun<Tables::EnclaveAccess, uint128_t, &Tables::EnclaveAccess::key>>;
+   using enclave_access_table_t = eosio::multi_index<Names::EnclaveAccessTable, Tables::EnclaveAccess, enclave_access_index_t>;
+   using script_enclaves_table_t = eosio::multi_index<Names::ScriptEnclavesTable, Tables::ScriptEnclaves>;
+   using grants_expiry_index_t = indexed_by<Names::GrantsExpiryIndex, const_mem_fun<Tables::GrantExpiry, uint64_t, &Tables::GrantExpiry::by_expiry>>;
+   using grants_key_index_t = indexed_by<Names::GrantsKeyIndex, const_mem_fun<Tables::GrantExpiry, checksum256, &Tables::GrantExpiry::grant_key>>;
+   using grants_expiry_table_t = eosio::multi_index<Names::GrantsExpiryTable, Tables::GrantExpiry, grants_expiry_index_t, grants_key_index_t>;
 
    /// @brief
    /// Aggregion script access permissions.
@@ -73,9 +329,34 @@ namespace aggregion::sar {
       [[eosio::action]] void execapprove(std::string provider, checksum256 hash);
       [[eosio::action]] void execdeny(std::string provider, checksum256 hash);
 
-      [[eosio::action]] void grantaccess(std::string owner, checksum256 hash, std::string grantee);
+      [[eosio::action]] void grantaccess(std::string owner, checksum256 hash, std::string grantee, eosio::binary_extension<uint32_t> expires_at);
       [[eosio::action]] void denyaccess(std::string owner, checksum256 hash, std::string grantee);
 
-      [[eosio::action]] void encscraccess(std::string enclave_owner, checksum256 script_hash, std::string grantee, bool granted);
+      [[eosio::action]] void encscraccess(std::string enclave_owner, checksum256 script_hash, std::string grantee, bool granted,
+                                          eosio::binary_extension<uint32_t> expires_at);
+
+      [[eosio::action]] void grantmany(std::string owner, std::vector<checksum256> hashes, std::vector<name> grantees, bool granted,
+                                       eosio::binary_extension<uint32_t> expires_at);
+      [[eosio::action]] void encgrantmany(std::string enclave_owner, std::vector<checksum256> hashes, std::vector<name> grantees, bool granted,
+                                          eosio::binary_extension<uint32_t> expires_at);
+
+      [[eosio::action]] void sweepgrants(uint64_t max_rows);
+      [[eosio::action]] void synctrust(uint64_t max_rows);
+
+      [[eosio::action]] void migrateesa(name enclave_owner, uint64_t max_rows);
+
+      [[eosio::action]] ExecutionVerdict canexec(name enclave_owner, checksum256 script_hash, name grantee);
+      [[eosio::action]] EnclaveSnapshot encsnapshot(name enclave_owner);
    };
+
+   uint64_t remove_script_rules(name self, uint64_t script_id, uint64_t limit);
+
+   void queue_trust_update(name self, TrustUpdateKind kind, name provider, uint64_t subject, bool value);
+   uint64_t apply_trust_updates(name self, uint64_t limit, uint64_t end);
+   uint64_t next_trust_update_id(name self);
+
+   uint64_t migrate_trusted_by(name self, migrations::RowCursor& cursor, uint64_t limit);
+   uint64_t migrate_script_approvers(name self, migrations::RowCursor& cursor, uint64_t limit);
+   uint64_t migrate_script_grantees(name self, migrations::RowCursor& cursor, uint64_t limit);
+   uint64_t migrate_trusted_approves(name self, migrations::RowCursor& cursor, uint64_t limit);
 }
\ No newline at end of file
@@ -1,12 +1,24 @@
 #include "Scripts.hpp"
+#include "Migrations.hpp"
+#include "ScriptAccessRules.hpp"
+#include "Utility.hpp"
+#include <algorithm>
+#include <limits>
 
 namespace aggregion::scripts {
 
    std::optional<uint64_t> get_script_id(name self, name owner, name script, name version) {
       scripts_table_t scripts{self, Names::DefaultScope};
       auto idx = scripts.get_index<Names::ScriptsVersionIndex>();
-      auto ait = idx.find(hash3s(owner, script, version));
-      if (ait == idx.end()) {
+      auto ait = idx.find(version_key(owner, script, version));
+      if (ait != idx.end()) {
+         return ait->id;
+      }
+      if (migrations::is_migrated(self, Names::ScriptsTable)) {
+         return std::nullopt;
+      }
+      ait = idx.find(legacy_version_key(owner, script, version));
+      if (ait == idx.end() || ait->get_keys_version() != 0) {
          return std::nullopt;
       }
       return ait->id;
@@ -22,6 +34,57 @@ namespace aggregion::scripts {
       return ait->id;
    }
 
+   int get_approves_count(name self, uint64_t script_id) {
+      script_stats_table_t stats{self, Names::DefaultScope};
+      auto it = stats.find(script_id);
+      if (it != stats.end()) {
+         return it->approves_count;
+      }
+      scripts_table_t scripts{self, Names::DefaultScope};
+      auto sit = scripts.require_find(script_id, "500. Script not found!");
+      return sit->approves_count;
+   }
+
+   bool is_removing(name self, uint64_t script_id) {
+      script_stats_table_t stats{self, Names::DefaultScope};
+      auto it = stats.find(script_id);
+      return it != stats.end() && it->removing.has_value() && it->removing.value();
+   }
+
+   void add_approves(name self, uint64_t script_id, int delta) {
+      script_stats_table_t stats{self, Names::DefaultScope};
+      auto it = stats.find(script_id);
+      if (it != stats.end()) {
+         stats.modify(it, self, [&](Tables::ScriptStats& row) {
+            row.approves_count += delta;
+         });
+         return;
+      }
+
+      // Script written before counters were moved out.
+      scripts_table_t scripts{self, Names::DefaultScope};
+      auto sit = scripts.find(script_id);
+      if (sit == scripts.end())
+         return;
+      stats.emplace(self, [&](Tables::ScriptStats& row) {
+         row.script_id = script_id;
+         row.approves_count = sit->approves_count + delta;
+      });
+   }
+
+   /// @brief
+   /// Take next script id from sequence.
+   /// Sequence starts after the highest existing id, ids removed before it was introduced may be taken once more.
+   uint64_t next_script_id(name self) {
+      scripts_table_t scripts{self, Names::DefaultScope};
+      scripts_sequence_t sequence{self, Names::DefaultScope};
+      auto state = sequence.get_or_default();
+      const auto id = std::max(state.next_id, scripts.available_primary_key());
+      state.next_id = id + 1;
+      sequence.set(state, self);
+      return id;
+   }
+
    /// @brief
    /// Add new script.
    void Scripts::addscript(std::string owner, std::string script, std::string version, std::string description, checksum256 hash, std::string url) {
@@ -34,8 +97,9 @@ namespace aggregion::scripts {
       check(get_script_id(get_self(), hash) == std::nullopt, "403. Script hash already exist!");
 
       scripts_table_t scripts{get_self(), Names::DefaultScope};
+      const auto id = next_script_id(get_self());
       scripts.emplace(get_self(), [&](Tables::Scripts& row) {
-         row.id = scripts.available_primary_key();
+         row.id = id;
          row.owner = o;
          row.script = s;
          row.version = v;
@@ -43,7 +107,16 @@ namespace aggregion::scripts {
          row.hash = hash;
          row.url = url;
          row.approves_count = 0;
+         row.keys_version.emplace(migrations::KeysVersion::Scripts);
       });
+
+      script_stats_table_t stats{get_self(), Names::DefaultScope};
+      stats.emplace(get_self(), [&](Tables::ScriptStats& row) {
+         row.script_id = id;
+         row.approves_count = 0;
+      });
+      // Scripts recount keeps next script id plus one, earlier scripts of owner are counted.
+      add_provider_row_stat(get_self(), o, ProviderCounter::Scripts, id + 1, 1);
       print("New script '", script, "', version '", version, "' was added by '", owner, "'");
    }
 
@@ -58,7 +131,8 @@ namespace aggregion::scripts {
 
       scripts_table_t scripts{get_self(), Names::DefaultScope};
       auto item = scripts.require_find(id.value(), "500. Script not found!");
-      check(item->approves_count == 0, "403. Can't update script. Script was approved!");
+      check(!is_removing(get_self(), item->id), "403. Script is being removed!");
+      check(get_approves_count(get_self(), item->id) == 0, "403. Can't update script. Script was approved!");
       check(item->owner == owner, "403. Wrong owner");
 
       scripts.modify(item, get_self(), [&](Tables::Scripts& row) {
@@ -80,10 +154,81 @@ namespace aggregion::scripts {
 
       scripts_table_t scripts{get_self(), Names::DefaultScope};
       auto item = scripts.require_find(id.value(), "500. Script not found!");
-      check(item->approves_count == 0, "403. Can't remove script. Script was approved!");
+      check(get_approves_count(get_self(), item->id) == 0, "403. Can't remove script. Script was approved!");
       check(item->owner == owner, "403. Wrong owner!");
 
+      script_stats_table_t stats{get_self(), Names::DefaultScope};
+      auto stit = stats.find(item->id);
+
+      // Not approved script may still have denials and access grants.
+      const auto removed = sar::remove_script_rules(get_self(), item->id, ScriptRemovalBatchSize);
+      if (removed == ScriptRemovalBatchSize) {
+         if (stit == stats.end()) {
+            stit = stats.emplace(get_self(), [&](Tables::ScriptStats& row) {
+               row.script_id = item->id;
+               row.approves_count = 0;
+            });
+         }
+         stats.modify(stit, get_self(), [&](Tables::ScriptStats& row) {
+            row.removing.emplace(true);
+         });
+         print("Script '", script, "', version '", version, "' removal is pending. Call 'remscript' again.");
+         return;
+      }
+
+      if (stit != stats.end()) {
+         stats.erase(stit);
+      }
+      const auto removed_id = item->id;
       scripts.erase(item);
+      add_provider_row_stat(get_self(), owner, ProviderCounter::Scripts, removed_id + 1, -1);
       print("Script '", script, "', version '", version, "' was removed by '", owner, "'");
    }
+
+
+   /// @brief
+   /// Read-only. Highest version of the script. Versions are compared as name values,
+   /// i.e. character by character in '.', '1'-'5', 'a'-'z' order ('v10' < 'v9'), not by insertion time.
+   /// Rows written before keys version 1 have hash keys, which may fall into the script range, they are skipped.
+   /// Such versions are found only after 'migrate'.
+   Tables::Scripts Scripts::latestscript(name owner, name script) {
+      scripts_table_t scripts{get_self(), Names::DefaultScope};
+      auto idx = scripts.get_index<Names::ScriptsVersionIndex>();
+      const auto begin = idx.lower_bound(version_key(owner, script, name{}));
+      auto it = idx.upper_bound(version_key(owner, script, name{std::numeric_limits<uint64_t>::max()}));
+      while (it != begin) {
+         --it;
+         if (it->get_keys_version() != 0) {
+            print("Latest version of script '", script, "' is '", it->version, "'. Id:", it->id);
+            return *it;
+         }
+      }
+      check(false, "404. Script not found");
+      return {};
+   }
+
+   /// @brief
+   /// Rewrite scripts starting from 'cursor' with current keys version.
+   /// Returns number of visited rows (less than 'limit' when table end is reached).
+   uint64_t migrate_keys(name self, uint64_t& cursor, uint64_t limit) {
+      scripts_table_t scripts{self, Names::DefaultScope};
+      uint64_t count = 0;
+      for (; count < limit; ++count) {
+         auto it = scripts.lower_bound(cursor);
+         if (it == scripts.end())
+            break;
+         cursor = it->id + 1;
+         if (it->get_keys_version() == migrations::KeysVersion::Scripts)
+            continue;
+
+         // Reinsert row, so every secondary index gets current key.
+         auto row = *it;
+         scripts.erase(it);
+         row.keys_version.emplace(migrations::KeysVersion::Scripts);
+         scripts.emplace(self, [&](Tables::Scripts& r) {
+            r = row;
+         });
+      }
+      return count;
+   }
 }
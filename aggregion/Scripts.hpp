@@ -1,8 +1,11 @@
 #pragma once
 
+#include "../common/Keys.hpp"
 #include "Names.hpp"
+#include <eosio/binary_extension.hpp>
 #include <eosio/crypto.hpp>
 #include <eosio/eosio.hpp>
+#include <eosio/singleton.hpp>
 #include <libc/bits/stdint.h>
 #include <optional>
 
@@ -10,14 +13,28 @@ namespace aggregion::scripts {
 
    using eosio::name;
 
-   static auto hash3s(name a, name b, name c) {
-      auto mix = a.to_string() + b.to_string() + c.to_string();
+   /// @brief
+   /// Script rules (approves, accesses) erased by one 'remscript' call.
+   static constexpr const uint64_t ScriptRemovalBatchSize = 100;
+
+   /// @brief
+   /// Script version key: packed (owner, script, version).
+   static auto version_key(name owner, name script, name version) {
+      return common::Keys::pack(owner.value, script.value, version.value);
+   }
+
+   /// @brief
+   /// Script version key of rows written before keys version 1.
+   static auto legacy_version_key(name owner, name script, name version) {
+      auto mix = owner.to_string() + script.to_string() + version.to_string();
       return sha256(mix.c_str(), mix.size());
    }
 
    struct Tables {
       /// @brief
       /// Scripts declaration table.
+      /// Rows are immutable except 'updscript', counters live in 'ScriptStats'.
+      /// ('approves_count' is used only by scripts without 'ScriptStats' row)
       /// Scope: Default.
       struct [[eosio::table, eosio::contract("Aggregion")]] Scripts {
          uint64_t id;
@@ -28,18 +45,52 @@ namespace aggregion::scripts {
          checksum256 hash;
          std::string url;
          int approves_count;
+         eosio::binary_extension<uint8_t> keys_version;
 
          auto primary_key() const {
             return id;
          }
 
-         auto script_version_key() const {
-            return hash3s(owner, script, version);
+         uint8_t get_keys_version() const {
+            return keys_version.has_value() ? keys_version.value() : 0;
+         }
+
+         checksum256 script_version_key() const {
+            if (get_keys_version() == 0) {
+               return legacy_version_key(owner, script, version);
+            }
+            return version_key(owner, script, version);
          }
 
          auto script_hash_key() const {
             return hash;
          }
+
+         uint128_t owner_script_key() const {
+            return common::Keys::pack(owner.value, script.value);
+         }
+      };
+
+      /// @brief
+      /// Scripts mutable counters.
+      /// 'removing' is set while 'remscript' erases script rules in batches.
+      /// Scope: Default.
+      struct [[eosio::table, eosio::contract("Aggregion")]] ScriptStats {
+         uint64_t script_id;
+         int approves_count;
+         eosio::binary_extension<bool> removing;
+
+         auto primary_key() const {
+            return script_id;
+         }
+      };
+
+      /// @brief
+      /// Next script id. Ids of removed scripts are not reused,
+      /// so enclave permissions left in 'encaccess' and 'encscraccess' never apply to another script.
+      /// Scope: Default.
+      struct [[eosio::table, eosio::contract("Aggregion")]] ScriptsSequence {
+         uint64_t next_id = 0;
       };
    };
 
@@ -47,9 +98,12 @@ namespace aggregion::scripts {
    struct Indexes {
       using scripts_version_idx_t = indexed_by<Names::ScriptsVersionIndex, const_mem_fun<Tables::Scripts, checksum256, &Tables::Scripts::script_version_key>>;
       using scripts_hash_idx_t = indexed_by<Names::ScriptsHashIndex, const_mem_fun<Tables::Scripts, checksum256, &Tables::Scripts::script_hash_key>>;
+      using scripts_owner_idx_t = indexed_by<Names::ScriptsOwnerIndex, const_mem_fun<Tables::Scripts, uint128_t, &Tables::Scripts::owner_script_key>>;
    };
 
-   using scripts_table_t = eosio::multi_index<Names::ScriptsTable, Tables::Scripts, Indexes::scripts_version_idx_t, Indexes::scripts_hash_idx_t>;
+   using scripts_table_t = eosio::multi_index<Names::ScriptsTable, Tables::Scripts, Indexes::scripts_version_idx_t, Indexes::scripts_hash_idx_t, Indexes::scripts_owner_idx_t>;
+   using script_stats_table_t = eosio::multi_index<Names::ScriptsStatsTable, Tables::ScriptStats>;
+   using scripts_sequence_t = eosio::singleton<Names::ScriptsSequenceTable, Tables::ScriptsSequence>;
 
    /// @brief
    /// Aggregion scripts.
@@ -59,8 +113,15 @@ namespace aggregion::scripts {
       [[eosio::action]] void addscript(std::string owner, std::string script, std::string version, std::string description, checksum256 hash, std::string url);
       [[eosio::action]] void updscript(name owner, name script, name version, std::string description, checksum256 hash, std::string url);
       [[eosio::action]] void remscript(name owner, name script, name version);
+      [[eosio::action]] Tables::Scripts latestscript(name owner, name script);
    };
 
    std::optional<uint64_t> get_script_id(name self, name owner, name script, name version);
    std::optional<uint64_t> get_script_id(name self, checksum256 hash);
+
+   int get_approves_count(name self, uint64_t script_id);
+   bool is_removing(name self, uint64_t script_id);
+   void add_approves(name self, uint64_t script_id, int delta);
+
+   uint64_t migrate_keys(name self, uint64_t& cursor, uint64_t limit);
 }
\ No newline at end of file
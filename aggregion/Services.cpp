@@ -1,5 +1,7 @@
 #include "Services.hpp"
+#include "Migrations.hpp"
 #include "Providers.hpp"
+#include "Utility.hpp"
 
 
 namespace aggregion {
@@ -9,6 +11,47 @@ namespace aggregion {
 
    namespace services {
 
+      void add_discovery(name self, name provider, name service, ServiceInfo const& info) {
+         services_discovery_table_t discovery{self, Names::DefaultScope};
+         const auto kind = service_kind(info.type, info.protocol);
+         auto idx = discovery.get_index<Names::ServicesDiscoveryIndex>();
+         auto it = idx.find(Tables::ServiceDiscovery::makeKey(kind, provider, service));
+         if (it != idx.end()) {
+            idx.modify(it, self, [&](Tables::ServiceDiscovery& row) {
+               row.info = info;
+            });
+            return;
+         }
+         discovery.emplace(self, [&](Tables::ServiceDiscovery& row) {
+            row.id = discovery.available_primary_key();
+            row.kind = kind;
+            row.provider = provider;
+            row.service = service;
+            row.info = info;
+         });
+      }
+
+      void remove_discovery(name self, name provider, name service, ServiceInfo const& info) {
+         services_discovery_table_t discovery{self, Names::DefaultScope};
+         auto idx = discovery.get_index<Names::ServicesDiscoveryIndex>();
+         auto it = idx.find(Tables::ServiceDiscovery::makeKey(service_kind(info.type, info.protocol), provider, service));
+         if (it != idx.end()) {
+            idx.erase(it);
+         }
+      }
+
+      /// @brief
+      /// Add discovery rows of services registered before discovery index.
+      /// Returns number of visited services.
+      uint64_t migrate_discovery(name self, migrations::RowCursor& cursor, uint64_t limit) {
+         return migrations::migrate_provider_rows(self, cursor, 1, limit, [&](name provider, uint8_t, uint64_t& key, uint64_t rows) {
+            services_table_t services{self, provider.value};
+            return migrations::migrate_rows(services, key, rows, [&](const auto& svc) {
+               add_discovery(self, provider, svc.service, svc.info);
+            });
+         });
+      }
+
       /// @brief
       /// Register provider service.
       void Services::addsvc(std::string provider, std::string service, ServiceInfo info) {
@@ -16,8 +59,7 @@ namespace aggregion {
          const auto s = name{service};
          require_auth(p);
 
-         providers_table_t providers{get_self(), Names::DefaultScope};
-         providers.require_find(p.value, "404. Unknown provider!");
+         check(is_provider(get_self(), p), "404. Unknown provider!");
 
          services_table_t services{get_self(), p.value};
          auto sit = services.find(s.value);
@@ -27,6 +69,8 @@ namespace aggregion {
             row.service = s;
             row.info = info;
          });
+         add_discovery(get_self(), p, s, info);
+         add_provider_row_stat(get_self(), p, ProviderCounter::Services, s.value, 1);
          print("Provider service '", s, "' was added by '", p, "'");
       }
 
@@ -36,12 +80,16 @@ namespace aggregion {
       void Services::updsvc(name provider, name service, ServiceInfo info) {
          require_auth(provider);
 
-         providers_table_t providers{get_self(), Names::DefaultScope};
-         providers.require_find(provider.value, "404. Unknown provider!");
+         // Services stage of pending unregistration may be already passed.
+         check(is_provider(get_self(), provider), "404. Unknown provider!");
 
          services_table_t services{get_self(), provider.value};
          auto sit = services.require_find(service.value, "404. Provider service not found!");
 
+         if (service_kind(info.type, info.protocol) != service_kind(sit->info.type, sit->info.protocol)) {
+            remove_discovery(get_self(), provider, service, sit->info);
+         }
+         add_discovery(get_self(), provider, service, info);
          services.modify(sit, get_self(), [&](Tables::Service& row) {
             row.info = info;
          });
@@ -54,14 +102,14 @@ namespace aggregion {
       void Services::remsvc(name provider, name service) {
          require_auth(provider);
 
-         providers_table_t providers{get_self(), Names::DefaultScope};
-         auto pit = providers.find(provider.value);
-         check(pit != providers.end(), "404. Unknown provider!");
+         check(is_provider(get_self(), provider), "404. Unknown provider!");
 
          services_table_t services{get_self(), provider.value};
          auto sit = services.require_find(service.value, "404. Unknown provider service!");
 
+         remove_discovery(get_self(), provider, service, sit->info);
          services.erase(sit);
+         add_provider_row_stat(get_self(), provider, ProviderCounter::Services, service.value, -1);
          print("Provider service '", service, "' was removed from '", provider, "'");
       }
    }
@@ -71,13 +119,14 @@ namespace aggregion {
       return services.begin() != services.end();
    }
 
-   void remove_provider_services(name self, name provider) {
+   uint64_t remove_provider_services(name self, name provider, uint64_t limit) {
       services_table_t services{self, provider.value};
-      while (true) {
-         auto it = services.begin();
-         if (it == services.end())
-            break;
-         services.erase(it);
+      uint64_t count = 0;
+      for (auto it = services.begin(); it != services.end() && count < limit; ++count) {
+         services::remove_discovery(self, provider, it->service, it->info);
+         add_provider_row_stat(self, provider, ProviderCounter::Services, it->service.value, -1);
+         it = services.erase(it);
       }
+      return count;
    }
 }
\ No newline at end of file
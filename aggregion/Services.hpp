@@ -1,5 +1,7 @@
 #pragma once
 
+#include "../common/Keys.hpp"
+#include "Migrations.hpp"
 #include "Names.hpp"
 #include <eosio/crypto.hpp>
 #include <eosio/eosio.hpp>
@@ -16,6 +18,14 @@ namespace aggregion::services {
       std::string endpoint;
    };
 
+   /// @brief
+   /// Service kind: first 128 bits of hash of (type, protocol).
+   static uint128_t service_kind(std::string const& type, std::string const& protocol) {
+      const auto h = common::Keys::hash(sha256(type.data(), type.size()), sha256(protocol.data(), protocol.size()));
+      const auto words = h.extract_as_word_array<uint64_t>();
+      return common::Keys::pack(words[0], words[1]);
+   }
+
 
    struct Tables {
 
@@ -30,9 +40,35 @@ namespace aggregion::services {
             return service.value;
          }
       };
+
+      /// @brief
+      /// Services of all providers ordered by kind.
+      /// 'info' is a copy of service info, so discovery is read by one range query.
+      /// Scope: Default.
+      struct [[eosio::table, eosio::contract("Aggregion")]] ServiceDiscovery {
+         uint64_t id;
+         uint128_t kind;
+         name provider;
+         name service;
+         ServiceInfo info;
+
+         auto primary_key() const {
+            return id;
+         }
+
+         static checksum256 makeKey(uint128_t kind, name provider, name service) {
+            return common::Keys::pack(static_cast<uint64_t>(kind >> 64), static_cast<uint64_t>(kind), provider.value, service.value);
+         }
+
+         checksum256 discovery_key() const {
+            return makeKey(kind, provider, service);
+         }
+      };
    };
 
    using services_table_t = eosio::multi_index<Names::ServicesTable, Tables::Service>;
+   using services_discovery_index_t = indexed_by<Names::ServicesDiscoveryIndex, const_mem_fun<Tables::ServiceDiscovery, checksum256, &Tables::ServiceDiscovery::discovery_key>>;
+   using services_discovery_table_t = eosio::multi_index<Names::ServicesDiscoveryTable, Tables::ServiceDiscovery, services_discovery_index_t>;
 
    /// @brief
    /// Provider services.
@@ -45,4 +81,8 @@ namespace aggregion::services {
       [[eosio::action]] void remsvc(name provider, name service);
    };
 
+   void add_discovery(name self, name provider, name service, ServiceInfo const& info);
+   void remove_discovery(name self, name provider, name service, ServiceInfo const& info);
+
+   uint64_t migrate_discovery(name self, migrations::RowCursor& cursor, uint64_t limit);
 }
\ No newline at end of file
@@ -7,13 +7,30 @@ namespace aggregion {
 
    using eosio::name;
 
+   /// @brief
+   /// Per-provider counters kept in 'provstats'.
+   enum class ProviderCounter : uint8_t {
+      Services, ///< registered services
+      Scripts,  ///< owned scripts
+      Trusts,   ///< trusted providers
+      Approves, ///< approved scripts
+      Grants,   ///< scripts access granted to provider
+   };
+
    bool is_provider(name self, name provider);
    bool provider_has_services(name self, name provider);
+   void add_provider_stat(name self, name provider, ProviderCounter counter, int64_t delta);
+   /// Change counter by counted row of provider, 'key' is row position within recount stage of counter.
+   /// Skipped while pending 'migrate provstats' has not visited the row yet, it is counted when visited.
+   void add_provider_row_stat(name self, name provider, ProviderCounter counter, uint64_t key, int64_t delta);
 
-   void remove_provider_services(name self, name provider);
-   void remove_provider_trusts(name self, name provider);
-   void remove_provider_approves(name self, name provider);
-   void remove_provider_accesses(name self, name provider);
-   void remove_provider_enclave_accesses(name self, name provider);
+   /// Provider dependent rows removal.
+   /// Each function erases at most 'limit' rows and returns number of erased rows.
+   uint64_t remove_provider_services(name self, name provider, uint64_t limit);
+   uint64_t remove_provider_trusts(name self, name provider, uint64_t limit);
+   uint64_t remove_provider_approves(name self, name provider, uint64_t limit);
+   uint64_t remove_provider_accesses(name self, name provider, uint64_t limit);
+   uint64_t remove_provider_enclave_accesses(name self, name provider, uint64_t limit);
+   uint64_t remove_provider_inbound_trusts(name self, name provider, uint64_t limit);
 
 }
@@ -1,4 +1,5 @@
 #include "Brands.hpp"
+#include "Journal.hpp"
 #include "Vendors.hpp"
 
 namespace catalogs::brands {
@@ -17,6 +18,7 @@ namespace catalogs::brands {
          row.name = name;
          row.vendors_count = 0;
       });
+      journal::record(get_self(), journal::EntityKind::Brand, brand_id, journal::Operation::Insert);
       print("New brand was added. Name: '", name, "' Id:", brand_id);
    }
 
@@ -29,6 +31,7 @@ namespace catalogs::brands {
       check(it->vendors_count == 0, "403. Brands has references to vendors");
 
       brands.erase(it);
+      journal::record(get_self(), journal::EntityKind::Brand, id, journal::Operation::Remove);
       print("Brand (id=", id, ") was removed");
    }
 
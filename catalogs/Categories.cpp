@@ -1,8 +1,61 @@
 #include "Categories.hpp"
+#include "Journal.hpp"
 #include "Translations.hpp"
+#include <algorithm>
+#include <map>
 
 namespace catalogs {
 
+   bool is_paths_initialized(name self) {
+      categories_paths_indexing_t indexing{self, Names::DefaultScope};
+      return indexing.exists() && indexing.get().done;
+   }
+
+   void check_paths_synced(name self) {
+      categories_paths_queue_table_t queue{self, Names::DefaultScope};
+      check(queue.begin() == queue.end(), "403. Category paths sync is in progress");
+   }
+
+   /// @brief
+   /// Create path row of category and count it in its ancestors, ancestors rows are created first.
+   /// Path row exists only if rows of all its ancestors exist.
+   void ensure_path(name self, const categories_table_t& categories, categories_paths_table_t& paths, uint64_t id) {
+      if (paths.find(id) != paths.end())
+         return;
+
+      const auto& category = categories.get(id, "500. Unknown category");
+      std::vector<uint64_t> ancestors;
+      if (category.parent_id) {
+         ensure_path(self, categories, paths, category.parent_id);
+         ancestors = paths.get(category.parent_id).ancestors;
+         ancestors.push_back(category.parent_id);
+      }
+      for (const auto ancestor : ancestors) {
+         paths.modify(paths.find(ancestor), self, [&](auto& row) {
+            row.descendants++;
+         });
+      }
+      paths.emplace(self, [&](auto& row) {
+         row.id = id;
+         row.depth = ancestors.size();
+         row.ancestors = ancestors;
+         row.descendants = 0;
+      });
+   }
+
+   void remove_path(name self, categories_paths_table_t& paths, uint64_t id) {
+      auto it = paths.find(id);
+      if (it == paths.end())
+         return;
+      for (const auto ancestor : it->ancestors) {
+         auto ait = paths.require_find(ancestor, "500. Category path not found");
+         paths.modify(ait, self, [&](auto& row) {
+            row.descendants--;
+         });
+      }
+      paths.erase(it);
+   }
+
    /// @brief
    /// Add new market catalog entry.
    /// @param id        Category ID
@@ -16,7 +69,9 @@ namespace catalogs {
       categories_table_t categories{get_self(), Names::DefaultScope};
 
       auto it = categories.find(id);
+      const auto op = it == categories.end() ? journal::Operation::Insert : journal::Operation::Update;
       if (it == categories.end()) {
+         check_paths_synced(get_self());
          it = categories.emplace(get_self(), [&](auto& row) {
             row.id = id;
             row.name = "";
@@ -29,12 +84,16 @@ namespace catalogs {
             categories.modify(pit, get_self(), [&](auto& row) {
                row.childs_count++;
             });
+            journal::record(get_self(), journal::EntityKind::Category, pit->id, journal::Operation::Update);
          }
+         categories_paths_table_t paths{get_self(), Names::DefaultScope};
+         ensure_path(get_self(), categories, paths, id);
       }
 
       check(it->parent_id == parent_id.value_or(0), "403. Cant change parent with catupsert");
 
       langs::upsert_translation<categories_translations_table_t>(get_self(), id, lang, name);
+      journal::record(get_self(), journal::EntityKind::Category, id, op, eosio::name{lang});
       print("Success. Category ID: ", it->id, " Lang: '", lang, "' Name: '", name, "'");
    }
 
@@ -50,10 +109,60 @@ namespace catalogs {
       check(categories.find(category_id) != categories.end(), "404. Category not found");
 
       langs::upsert_translation<categories_translations_table_t>(get_self(), category_id, lang, name);
+      journal::record(get_self(), journal::EntityKind::Category, category_id, journal::Operation::Update, eosio::name{lang});
       print("Success. Category ID: ", category_id, " Lang: '", lang, "' Name: '", name, "'");
    }
 
 
+   /// @brief
+   /// Insert categories and their translations (existing categories get translations only).
+   /// Parent may be imported earlier in the same batch, parents children counters are written once.
+   /// @param items  Categories with translations.
+   void Categories::catimport(std::vector<CategoryImport> items) {
+      require_auth(Names::Contract);
+
+      categories_table_t categories{get_self(), Names::DefaultScope};
+      categories_paths_table_t paths{get_self(), Names::DefaultScope};
+      std::map<uint64_t, int> childs;
+      std::set<name> ensured;
+      for (const auto& item : items) {
+         check(item.id != 0, "403. Category ID can't be zero");
+         const auto parent_id = item.parent_id.value_or(0);
+         auto it = categories.find(item.id);
+         const auto op = it == categories.end() ? journal::Operation::Insert : journal::Operation::Update;
+         if (it == categories.end()) {
+            check_paths_synced(get_self());
+            if (parent_id != 0 && childs.count(parent_id) == 0) {
+               check(categories.find(parent_id) != categories.end(), "404. Parent category not found");
+            }
+            categories.emplace(get_self(), [&](auto& row) {
+               row.id = item.id;
+               row.name = "";
+               row.parent_id = parent_id;
+               row.childs_count = 0;
+            });
+            if (parent_id != 0) {
+               childs[parent_id]++;
+            }
+            ensure_path(get_self(), categories, paths, item.id);
+         } else {
+            check(it->parent_id == parent_id, "403. Cant change parent with catimport");
+         }
+         langs::import_translations<categories_translations_table_t>(get_self(), item.id, item.names, ensured);
+         journal::record(get_self(), journal::EntityKind::Category, item.id, op);
+      }
+
+      for (const auto& [parent_id, count] : childs) {
+         auto pit = categories.require_find(parent_id, "500. Unknown parent category");
+         categories.modify(pit, get_self(), [&](auto& row) {
+            row.childs_count += count;
+         });
+         journal::record(get_self(), journal::EntityKind::Category, parent_id, journal::Operation::Update);
+      }
+      print("Success. Categories imported: ", items.size());
+   }
+
+
    /// @brief
    /// Remove category catalog entry.
    /// @param id  Category ID.
@@ -63,6 +172,7 @@ namespace catalogs {
       categories_table_t categories{get_self(), Names::DefaultScope};
       auto it = categories.require_find(id, "404. Category not found");
       check(it->childs_count == 0, "403. Category has subcategories");
+      check_paths_synced(get_self());
 
       if (it->parent_id) {
          auto pit = categories.find(it->parent_id);
@@ -70,10 +180,183 @@ namespace catalogs {
          categories.modify(pit, get_self(), [&](auto& row) {
             row.childs_count--;
          });
+         journal::record(get_self(), journal::EntityKind::Category, pit->id, journal::Operation::Update);
       }
       langs::remove_translations<categories_translations_table_t>(get_self(), it->id);
+      categories_paths_table_t paths{get_self(), Names::DefaultScope};
+      remove_path(get_self(), paths, id);
       categories.erase(it);
+      journal::record(get_self(), journal::EntityKind::Category, id, journal::Operation::Remove);
       print("Category (id=", id, ") was removed");
    }
 
+
+   /// @brief
+   /// Move category with its subtree under another parent (root if 'parent_id' is null).
+   /// Descendants counters are updated at once, descendants paths are rewritten by 'catpathsync'.
+   /// @param id         Category ID
+   /// @param parent_id  New parent category.
+   void Categories::catreparent(uint64_t id, std::optional<uint64_t> parent_id) {
+      require_auth(Names::Contract);
+      check(is_paths_initialized(get_self()), "403. Category paths are not initialized");
+      check_paths_synced(get_self());
+
+      categories_table_t categories{get_self(), Names::DefaultScope};
+      categories_paths_table_t paths{get_self(), Names::DefaultScope};
+      auto it = categories.require_find(id, "404. Category not found");
+      auto mit = paths.require_find(id, "500. Category path not found");
+      const auto new_parent_id = parent_id.value_or(0);
+      check(it->parent_id != new_parent_id, "403. Category already has specified parent");
+
+      std::vector<uint64_t> ancestors;
+      if (new_parent_id) {
+         auto pit = categories.require_find(new_parent_id, "404. Parent category not found");
+         const auto& parent = paths.get(new_parent_id, "500. Category path not found");
+         const auto in_subtree = std::find(parent.ancestors.begin(), parent.ancestors.end(), id) != parent.ancestors.end();
+         check(new_parent_id != id && !in_subtree, "403. Category can't be moved into its subtree");
+         ancestors = parent.ancestors;
+         ancestors.push_back(new_parent_id);
+         categories.modify(pit, get_self(), [&](auto& row) {
+            row.childs_count++;
+         });
+         journal::record(get_self(), journal::EntityKind::Category, new_parent_id, journal::Operation::Update);
+      }
+      if (it->parent_id) {
+         auto pit = categories.require_find(it->parent_id, "500. Unknown parent category");
+         categories.modify(pit, get_self(), [&](auto& row) {
+            row.childs_count--;
+         });
+         journal::record(get_self(), journal::EntityKind::Category, pit->id, journal::Operation::Update);
+      }
+      categories.modify(it, get_self(), [&](auto& row) {
+         row.parent_id = new_parent_id;
+      });
+
+      const auto moved = mit->descendants + 1;
+      for (const auto ancestor : mit->ancestors) {
+         paths.modify(paths.find(ancestor), get_self(), [&](auto& row) {
+            row.descendants -= moved;
+         });
+      }
+      for (const auto ancestor : ancestors) {
+         paths.modify(paths.find(ancestor), get_self(), [&](auto& row) {
+            row.descendants += moved;
+         });
+      }
+      paths.modify(mit, get_self(), [&](auto& row) {
+         row.depth = ancestors.size();
+         row.ancestors = ancestors;
+      });
+
+      if (mit->descendants > 0) {
+         categories_paths_queue_table_t queue{get_self(), Names::DefaultScope};
+         queue.emplace(get_self(), [&](auto& row) {
+            row.id = queue.available_primary_key();
+            row.category_id = id;
+            row.cursor = 0;
+         });
+      }
+      journal::record(get_self(), journal::EntityKind::Category, id, journal::Operation::Update);
+      print("Category (id=", id, ") moved to parent (id=", new_parent_id, ") Descendants: ", mit->descendants);
+   }
+
+
+   /// @brief
+   /// Rewrite at most 'max_rows' paths of moved subtrees descendants (breadth first).
+   void Categories::catpathsync(uint64_t max_rows) {
+      require_auth(Names::Contract);
+      check(max_rows > 0, "403. Rows limit must be positive!");
+
+      categories_paths_queue_table_t queue{get_self(), Names::DefaultScope};
+      categories_paths_table_t paths{get_self(), Names::DefaultScope};
+      auto idx = paths.get_index<Names::CategoriesPathsByParIdx>();
+      uint64_t count = 0;
+      while (count < max_rows && queue.begin() != queue.end()) {
+         auto qit = queue.begin();
+         const auto parent_id = qit->category_id;
+         auto ancestors = paths.get(parent_id, "500. Category path not found").ancestors;
+         ancestors.push_back(parent_id);
+
+         auto cursor = qit->cursor;
+         auto cit = idx.lower_bound(Tables::CategoriesPaths::makeKey(parent_id, cursor));
+         for (; cit != idx.end() && cit->parent_id() == parent_id && count < max_rows; ++cit, ++count) {
+            // Parent stays last ancestor, so row keeps its index position.
+            idx.modify(cit, get_self(), [&](auto& row) {
+               row.depth = ancestors.size();
+               row.ancestors = ancestors;
+            });
+            if (cit->descendants > 0) {
+               queue.emplace(get_self(), [&](auto& row) {
+                  row.id = queue.available_primary_key();
+                  row.category_id = cit->id;
+                  row.cursor = 0;
+               });
+            }
+            cursor = cit->id + 1;
+         }
+
+         if (cit == idx.end() || cit->parent_id() != parent_id) {
+            queue.erase(qit);
+         } else {
+            queue.modify(qit, get_self(), [&](auto& row) {
+               row.cursor = cursor;
+            });
+         }
+      }
+      print("Category paths synced: ", count, " Done: ", queue.begin() == queue.end());
+   }
+
+
+   /// @brief
+   /// Read-only. Category names in 'lang' from root to category, empty name when translation is missing.
+   /// Materialized ancestors are used unless paths are being synced or initialized, then parents are followed.
+   std::vector<std::string> Categories::catpath(uint64_t id, std::string lang) {
+      categories_table_t categories{get_self(), Names::DefaultScope};
+      categories_paths_table_t paths{get_self(), Names::DefaultScope};
+      categories_paths_queue_table_t queue{get_self(), Names::DefaultScope};
+
+      std::vector<uint64_t> ids;
+      auto pit = paths.find(id);
+      if (pit != paths.end() && queue.begin() == queue.end()) {
+         ids = pit->ancestors;
+         ids.push_back(id);
+      } else {
+         for (auto cid = id; cid != 0; cid = categories.get(cid, "404. Category not found").parent_id) {
+            ids.insert(ids.begin(), cid);
+         }
+      }
+
+      categories_translations_table_t trans{get_self(), name{lang}.value};
+      std::vector<std::string> result;
+      for (const auto cid : ids) {
+         auto tit = trans.find(cid);
+         result.push_back(tit != trans.end() ? tit->name : std::string{});
+      }
+      return result;
+   }
+
+
+   /// @brief
+   /// Create paths of at most 'max_rows' categories created before 'catpaths' was introduced.
+   void Categories::catpathinit(uint64_t max_rows) {
+      require_auth(Names::Contract);
+      check(max_rows > 0, "403. Rows limit must be positive!");
+
+      categories_paths_indexing_t indexing{get_self(), Names::DefaultScope};
+      auto state = indexing.get_or_default();
+      check(!state.done, "403. Category paths are already initialized!");
+
+      categories_table_t categories{get_self(), Names::DefaultScope};
+      categories_paths_table_t paths{get_self(), Names::DefaultScope};
+      uint64_t count = 0;
+      auto it = categories.lower_bound(state.cursor);
+      for (; it != categories.end() && count < max_rows; ++it, ++count) {
+         ensure_path(get_self(), categories, paths, it->id);
+         state.cursor = it->id + 1;
+      }
+      state.done = it == categories.end();
+      indexing.set(state, get_self());
+      print("Category paths initialized: ", count, " Done: ", state.done);
+   }
+
 }
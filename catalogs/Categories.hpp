@@ -1,8 +1,11 @@
 #pragma once
 
 #include "Names.hpp"
+#include "Translations.hpp"
 #include <eosio/eosio.hpp>
+#include <eosio/singleton.hpp>
 #include <optional>
+#include <vector>
 
 namespace catalogs {
 
@@ -37,11 +40,70 @@ namespace catalogs {
             return id;
          }
       };
+
+      /// @brief
+      /// Materialized category paths: ancestors from root and number of all descendants.
+      /// Scope: Default.
+      struct [[eosio::table, eosio::contract("Catalogs")]] CategoriesPaths {
+         uint64_t id;
+         uint32_t depth;
+         std::vector<uint64_t> ancestors;
+         uint64_t descendants;
+
+         auto primary_key() const {
+            return id;
+         }
+
+         uint64_t parent_id() const {
+            return ancestors.empty() ? 0 : ancestors.back();
+         }
+
+         uint128_t by_parent() const {
+            return makeKey(parent_id(), id);
+         }
+
+         static uint128_t makeKey(uint64_t parent_id, uint64_t id) {
+            return (static_cast<uint128_t>(parent_id) << 64) | id;
+         }
+      };
+
+      /// @brief
+      /// Categories which descendants paths must be rewritten after reparent.
+      /// Scope: Default.
+      struct [[eosio::table, eosio::contract("Catalogs")]] CategoriesPathsQueue {
+         uint64_t id;
+         uint64_t category_id;
+         uint64_t cursor;
+
+         auto primary_key() const {
+            return id;
+         }
+      };
+
+      /// @brief
+      /// Paths initialization of categories created before 'catpaths' was introduced.
+      /// Scope: Default.
+      struct [[eosio::table, eosio::contract("Catalogs")]] CategoriesPathsIndexing {
+         uint64_t cursor = 0;
+         bool done = false;
+      };
    };
 
    using categories_byparent_index_t = indexed_by<Names::CategoriesByParIdx, const_mem_fun<Tables::Categories, uint64_t, &Tables::Categories::by_parent>>;
    using categories_table_t = eosio::multi_index<Names::CategoriesTable, Tables::Categories, categories_byparent_index_t>;
    using categories_translations_table_t = eosio::multi_index<Names::CategoriesTranslationsTable, Tables::CategoriesTranslations>;
+   using categories_paths_byparent_index_t = indexed_by<Names::CategoriesPathsByParIdx, const_mem_fun<Tables::CategoriesPaths, uint128_t, &Tables::CategoriesPaths::by_parent>>;
+   using categories_paths_table_t = eosio::multi_index<Names::CategoriesPathsTable, Tables::CategoriesPaths, categories_paths_byparent_index_t>;
+   using categories_paths_queue_table_t = eosio::multi_index<Names::CategoriesPathsQueueTable, Tables::CategoriesPathsQueue>;
+   using categories_paths_indexing_t = eosio::singleton<Names::CategoriesPathsIndexingTable, Tables::CategoriesPathsIndexing>;
+
+   /// @brief
+   /// Category with translations (bulk import item).
+   struct CategoryImport {
+      uint64_t id;
+      std::optional<uint64_t> parent_id;
+      std::vector<langs::Translation> names;
+   };
 
    /// @brief
    /// Aggregion categories catalog.
@@ -51,5 +113,10 @@ namespace catalogs {
       [[eosio::action]] void catupsert(uint64_t id, std::optional<uint64_t> parent_id, std::string lang, std::string name);
       [[eosio::action]] void catuptrans(uint64_t category_id, std::string lang, std::string name);
       [[eosio::action]] void catremove(uint64_t category_id);
+      [[eosio::action]] void catimport(std::vector<CategoryImport> items);
+      [[eosio::action]] void catreparent(uint64_t id, std::optional<uint64_t> parent_id);
+      [[eosio::action]] void catpathsync(uint64_t max_rows);
+      [[eosio::action]] void catpathinit(uint64_t max_rows);
+      [[eosio::action]] std::vector<std::string> catpath(uint64_t id, std::string lang);
    };
 }
@@ -1,13 +1,36 @@
 #include "Cities.hpp"
 #include "CityTypes.hpp"
+#include "Journal.hpp"
 #include "Regions.hpp"
 #include "Translations.hpp"
+#include <map>
 
 namespace catalogs::cities {
 
    using catalogs::citytypes::citytypes_table_t;
    using catalogs::regions::regions_table_t;
 
+   /// @brief
+   /// Update city row. Row without current keys is reinserted, so every secondary index gets its key,
+   /// its population is counted in region since then.
+   /// Returns change of region population.
+   template <typename Updater>
+   int64_t update_city(name self, cities_table_t& cities, cities_table_t::const_iterator it, Updater&& update) {
+      if (it->get_keys_version() == KeysVersion) {
+         const auto population = it->population;
+         cities.modify(it, self, update);
+         return static_cast<int64_t>(it->population) - static_cast<int64_t>(population);
+      }
+      auto row = *it;
+      cities.erase(it);
+      update(row);
+      row.keys_version.emplace(KeysVersion);
+      cities.emplace(self, [&](auto& r) {
+         r = row;
+      });
+      return row.population;
+   }
+
    void Cities::cityinsert(uint64_t id, uint64_t region_id, uint64_t type_id, std::string lang, std::string name, uint64_t population) {
       require_auth(Names::Contract);
       check(id != 0, "403. City ID can't be zero");
@@ -16,13 +39,16 @@ namespace catalogs::cities {
       auto rit = regions.require_find(region_id, "404. Region not found");
       regions.modify(rit, get_self(), [&](auto& row) {
          row.cities_count++;
+         row.population.emplace(row.get_population() + population);
       });
+      journal::record(get_self(), journal::EntityKind::Region, region_id, journal::Operation::Update);
 
       citytypes_table_t citytypes{get_self(), Names::DefaultScope};
       auto stit = citytypes.require_find(type_id, "404. Citytype not found");
       citytypes.modify(stit, get_self(), [&](auto& row) {
          row.cities_count++;
       });
+      journal::record(get_self(), journal::EntityKind::CityType, type_id, journal::Operation::Update);
 
       cities_table_t cities{get_self(), Names::DefaultScope};
       auto it = cities.find(id);
@@ -36,10 +62,12 @@ namespace catalogs::cities {
             }
             row.type_id = type_id;
             row.population = population;
+            row.keys_version.emplace(KeysVersion);
          });
       }
 
       langs::upsert_translation<cities_translations_table_t>(get_self(), id, lang, name);
+      journal::record(get_self(), journal::EntityKind::City, id, journal::Operation::Insert, eosio::name{lang});
       print("Success. City ID: ", id, ". Name: ", name);
    }
 
@@ -53,20 +81,110 @@ namespace catalogs::cities {
          });
       }
       langs::upsert_translation<cities_translations_table_t>(get_self(), id, lang, name);
+      journal::record(get_self(), journal::EntityKind::City, id, journal::Operation::Update, eosio::name{lang});
+   }
+
+   /// @brief
+   /// Insert cities and their translations, existing cities get population and translations.
+   /// Regions and city types are checked once per batch, their cities counters are written once.
+   void Cities::cityimport(std::vector<CityImport> items) {
+      require_auth(Names::Contract);
+
+      regions_table_t regions{get_self(), Names::DefaultScope};
+      citytypes_table_t citytypes{get_self(), Names::DefaultScope};
+      cities_table_t cities{get_self(), Names::DefaultScope};
+      std::map<uint64_t, int> region_cities;
+      std::map<uint64_t, int64_t> region_population;
+      std::map<uint64_t, int> type_cities;
+      std::set<name> ensured;
+      for (const auto& item : items) {
+         check(item.id != 0, "403. City ID can't be zero");
+         std::string ru_name;
+         for (const auto& t : item.names) {
+            if (t.lang == "ru") {
+               ru_name = t.name;
+            }
+         }
+
+         auto it = cities.find(item.id);
+         const auto op = it == cities.end() ? journal::Operation::Insert : journal::Operation::Update;
+         if (it == cities.end()) {
+            if (region_cities.count(item.region_id) == 0) {
+               regions.require_find(item.region_id, "404. Region not found");
+            }
+            if (type_cities.count(item.type_id) == 0) {
+               citytypes.require_find(item.type_id, "404. Citytype not found");
+            }
+            region_cities[item.region_id]++;
+            type_cities[item.type_id]++;
+            cities.emplace(get_self(), [&](auto& row) {
+               row.id = item.id;
+               row.region_id = item.region_id;
+               row.name = ru_name;
+               row.type_id = item.type_id;
+               row.population = item.population;
+               row.keys_version.emplace(KeysVersion);
+            });
+            region_population[item.region_id] += item.population;
+         } else {
+            check(it->region_id == item.region_id && it->type_id == item.type_id, "403. Cant change city region or type with cityimport");
+            region_population[item.region_id] += update_city(get_self(), cities, it, [&](auto& row) {
+               row.population = item.population;
+               if (!ru_name.empty()) {
+                  row.name = ru_name;
+               }
+            });
+         }
+         langs::import_translations<cities_translations_table_t>(get_self(), item.id, item.names, ensured);
+         journal::record(get_self(), journal::EntityKind::City, item.id, op);
+      }
+
+      for (const auto& [region_id, population] : region_population) {
+         auto rit = regions.require_find(region_id, "500. Unknown region");
+         check(population >= 0 || rit->get_population() >= static_cast<uint64_t>(-population), "500. Region population underflow");
+         regions.modify(rit, get_self(), [&](auto& row) {
+            row.cities_count += region_cities[region_id];
+            row.population.emplace(row.get_population() + population);
+         });
+         journal::record(get_self(), journal::EntityKind::Region, region_id, journal::Operation::Update);
+      }
+      for (const auto& [type_id, count] : type_cities) {
+         auto tit = citytypes.require_find(type_id, "500. Unknown city type");
+         citytypes.modify(tit, get_self(), [&](auto& row) {
+            row.cities_count += count;
+         });
+         journal::record(get_self(), journal::EntityKind::CityType, type_id, journal::Operation::Update);
+      }
+      print("Success. Cities imported: ", items.size());
    }
 
    void Cities::citychtype(uint64_t id, uint64_t type_id) {
       require_auth(Names::Contract);
 
       citytypes_table_t citytypes{get_self(), Names::DefaultScope};
-      check(citytypes.find(type_id) != citytypes.end(), "403. Unknown city type");
+      const auto tit = citytypes.find(type_id);
+      check(tit != citytypes.end(), "403. Unknown city type");
 
       cities_table_t cities{get_self(), Names::DefaultScope};
       const auto cit = cities.require_find(id, "404. City not found");
-      cities.modify(cit, get_self(), [&](auto& row) {
+      const auto region_id = cit->region_id;
+      if (cit->type_id != type_id) {
+         auto oldit = citytypes.require_find(cit->type_id, "500. Unknown city type");
+         citytypes.modify(oldit, get_self(), [&](auto& row) {
+            row.cities_count--;
+         });
+         journal::record(get_self(), journal::EntityKind::CityType, oldit->id, journal::Operation::Update);
+         citytypes.modify(tit, get_self(), [&](auto& row) {
+            row.cities_count++;
+         });
+         journal::record(get_self(), journal::EntityKind::CityType, type_id, journal::Operation::Update);
+      }
+      const auto population = update_city(get_self(), cities, cit, [&](auto& row) {
          row.type_id = type_id;
       });
-      print("Success. City ID: ", cit->id, ". New type: ", cit->type_id);
+      regions::add_region_population(get_self(), region_id, population);
+      journal::record(get_self(), journal::EntityKind::City, id, journal::Operation::Update);
+      print("Success. City ID: ", id, ". New type: ", type_id);
    }
 
 
@@ -78,18 +196,56 @@ namespace catalogs::cities {
 
       regions_table_t region{get_self(), Names::DefaultScope};
       auto rit = region.require_find(it->region_id, "500. Unknown region");
+      const auto population = it->get_keys_version() == KeysVersion ? it->population : 0;
+      check(rit->get_population() >= population, "500. Region population underflow");
       region.modify(rit, get_self(), [&](auto& row) {
          row.cities_count--;
+         row.population.emplace(row.get_population() - population);
       });
+      journal::record(get_self(), journal::EntityKind::Region, rit->id, journal::Operation::Update);
 
       citytypes_table_t citytypes{get_self(), Names::DefaultScope};
       auto stit = citytypes.require_find(it->type_id, "500. Unknown city type");
       citytypes.modify(stit, get_self(), [&](auto& row) {
          row.cities_count--;
       });
+      journal::record(get_self(), journal::EntityKind::CityType, stit->id, journal::Operation::Update);
 
       cities.erase(it);
+      journal::record(get_self(), journal::EntityKind::City, city_id, journal::Operation::Remove);
       langs::remove_translations<cities_translations_table_t>(get_self(), city_id);
       print("Success. City ID: ", city_id, " was removed");
    }
+
+
+   /// @brief
+   /// Rewrite at most 'max_rows' cities written before current keys version,
+   /// so they get into (region, type) and (region, population) indexes and are counted in regions population.
+   void Cities::citymigrate(uint64_t max_rows) {
+      require_auth(Names::Contract);
+      check(max_rows > 0, "403. Rows limit must be positive!");
+
+      cities_migration_t migration{get_self(), Names::DefaultScope};
+      auto state = migration.get_or_default();
+      check(!state.done, "403. Cities are already migrated!");
+
+      cities_table_t cities{get_self(), Names::DefaultScope};
+      std::map<uint64_t, int64_t> region_population;
+      uint64_t count = 0;
+      for (; count < max_rows; ++count) {
+         auto it = cities.lower_bound(state.cursor);
+         if (it == cities.end())
+            break;
+         state.cursor = it->id + 1;
+         if (it->get_keys_version() == KeysVersion)
+            continue;
+         region_population[it->region_id] += update_city(get_self(), cities, it, [](auto&) {});
+      }
+      for (const auto& [region_id, population] : region_population) {
+         regions::add_region_population(get_self(), region_id, population);
+      }
+      state.done = count < max_rows;
+      migration.set(state, get_self());
+      print("Cities migrated: ", count, " Done: ", state.done);
+   }
 }
@@ -1,11 +1,20 @@
 #pragma once
 
 #include "Names.hpp"
+#include "Translations.hpp"
+#include <eosio/binary_extension.hpp>
 #include <eosio/eosio.hpp>
+#include <eosio/singleton.hpp>
 #include <optional>
+#include <vector>
 
 namespace catalogs::cities {
 
+   /// @brief
+   /// Current version of cities secondary keys.
+   /// 1 - (region, type) and (region, population desc) indexes, population counted in region.
+   static constexpr const uint8_t KeysVersion = 1;
+
    struct Tables {
 
       struct [[eosio::table, eosio::contract("Catalogs")]] Cities {
@@ -14,6 +23,7 @@ namespace catalogs::cities {
          uint64_t region_id;
          uint64_t type_id;
          uint64_t population;
+         eosio::binary_extension<uint8_t> keys_version;
 
          uint64_t primary_key() const {
             return id;
@@ -22,6 +32,31 @@ namespace catalogs::cities {
          uint64_t by_region() const {
             return region_id;
          }
+
+         uint128_t by_region_type() const {
+            return makeKey(region_id, type_id);
+         }
+
+         /// Largest cities first.
+         uint128_t by_region_population() const {
+            return makeKey(region_id, ~population);
+         }
+
+         uint8_t get_keys_version() const {
+            return keys_version.has_value() ? keys_version.value() : 0;
+         }
+
+         static uint128_t makeKey(uint64_t high, uint64_t low) {
+            return (static_cast<uint128_t>(high) << 64) | low;
+         }
+      };
+
+      /// @brief
+      /// Cities keys migration progress, rows before 'cursor' have current keys.
+      /// Scope: Default.
+      struct [[eosio::table, eosio::contract("Catalogs")]] CitiesMigration {
+         uint64_t cursor = 0;
+         bool done = false;
       };
 
       /// @brief
@@ -38,9 +73,22 @@ namespace catalogs::cities {
    };
 
    using cities_byregion_index_t = indexed_by<Names::CitiesByRegionIndex, const_mem_fun<Tables::Cities, uint64_t, &Tables::Cities::by_region>>;
-   using cities_table_t = eosio::multi_index<Names::CitiesTable, Tables::Cities, cities_byregion_index_t>;
+   using cities_byregiontype_index_t = indexed_by<Names::CitiesByRegionTypeIndex, const_mem_fun<Tables::Cities, uint128_t, &Tables::Cities::by_region_type>>;
+   using cities_byregionpop_index_t = indexed_by<Names::CitiesByRegionPopulationIndex, const_mem_fun<Tables::Cities, uint128_t, &Tables::Cities::by_region_population>>;
+   using cities_table_t = eosio::multi_index<Names::CitiesTable, Tables::Cities, cities_byregion_index_t, cities_byregiontype_index_t, cities_byregionpop_index_t>;
+   using cities_migration_t = eosio::singleton<Names::CitiesMigrationTable, Tables::CitiesMigration>;
    using cities_translations_table_t = eosio::multi_index<Names::CitiesTranslationsTable, Tables::CitiesTranslations>;
 
+   /// @brief
+   /// City with translations (bulk import item).
+   struct CityImport {
+      uint64_t id;
+      uint64_t region_id;
+      uint64_t type_id;
+      uint64_t population;
+      std::vector<langs::Translation> names;
+   };
+
    struct [[eosio::contract("Catalogs")]] Cities : contract {
       using contract::contract;
 
@@ -48,5 +96,7 @@ namespace catalogs::cities {
       [[eosio::action]] void citychtype(uint64_t id, uint64_t type_id);
       [[eosio::action]] void citytrans(uint64_t id, std::string lang, std::string name);
       [[eosio::action]] void cityremove(uint64_t city_id);
+      [[eosio::action]] void cityimport(std::vector<CityImport> items);
+      [[eosio::action]] void citymigrate(uint64_t max_rows);
    };
 }
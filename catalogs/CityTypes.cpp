@@ -1,4 +1,5 @@
 #include "CityTypes.hpp"
+#include "Journal.hpp"
 #include "Translations.hpp"
 
 namespace catalogs::citytypes {
@@ -21,6 +22,8 @@ namespace catalogs::citytypes {
          });
       }
       langs::upsert_translation<citytypes_translations_table_t>(get_self(), it->id, lang, name);
+      const auto op = mustExists ? journal::Operation::Update : journal::Operation::Insert;
+      journal::record(get_self(), journal::EntityKind::CityType, id, op, eosio::name{lang});
       print("Success. City type ID: ", it->id, " Lang: '", lang, "' Name: '", name, "'");
    }
 
@@ -41,6 +44,7 @@ namespace catalogs::citytypes {
       citytypes.erase(it);
 
       langs::remove_translations<citytypes_translations_table_t>(get_self(), citytype_id);
+      journal::record(get_self(), journal::EntityKind::CityType, citytype_id, journal::Operation::Remove);
       print("Success. City type ID: ", citytype_id, " was removed");
    }
 
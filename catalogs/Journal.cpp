@@ -0,0 +1,49 @@
+#include "Journal.hpp"
+
+namespace catalogs::journal {
+
+   /// @brief
+   /// Append change to journal with next revision.
+   uint64_t record(name self, EntityKind kind, uint64_t entity_id, Operation op, name lang) {
+      revision_t revision{self, Names::DefaultScope};
+      auto state = revision.get_or_default();
+      state.revision++;
+      revision.set(state, self);
+
+      journal_table_t journal{self, Names::DefaultScope};
+      journal.emplace(self, [&](Tables::Journal& row) {
+         row.revision = state.revision;
+         row.kind = static_cast<uint8_t>(kind);
+         row.entity_id = entity_id;
+         row.lang = lang;
+         row.op = static_cast<uint8_t>(op);
+      });
+      return state.revision;
+   }
+
+
+   /// @brief
+   /// Erase at most 'max_rows' journal rows older than 'before_revision'.
+   void Journal::catcompact(uint64_t before_revision, uint64_t max_rows) {
+      require_auth(Names::Contract);
+      check(max_rows > 0, "403. Rows limit must be positive!");
+
+      revision_t revision{get_self(), Names::DefaultScope};
+      auto state = revision.get_or_default();
+      check(before_revision <= state.revision + 1, "403. Revision is in the future!");
+
+      journal_table_t journal{get_self(), Names::DefaultScope};
+      uint64_t count = 0;
+      auto it = journal.begin();
+      for (; it != journal.end() && it->revision < before_revision && count < max_rows; ++count) {
+         it = journal.erase(it);
+      }
+      // Journal keeps all revisions since first remaining row.
+      const auto compacted_before = (it == journal.end() || it->revision >= before_revision) ? before_revision : it->revision;
+      if (compacted_before > state.compacted_before) {
+         state.compacted_before = compacted_before;
+         revision.set(state, get_self());
+      }
+      print("Journal rows removed: ", count, " Compacted before: ", state.compacted_before);
+   }
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "Names.hpp"
+#include <eosio/eosio.hpp>
+#include <eosio/singleton.hpp>
+
+namespace catalogs::journal {
+
+   /// @brief
+   /// Catalog entities tracked by journal.
+   enum class EntityKind : uint8_t {
+      Category,
+      Region,
+      City,
+      CityType,
+      Place,
+      Vendor,
+      Brand,
+      VendorBrand,
+   };
+
+   /// @brief
+   /// Journaled change. Change with empty 'lang' refers to entity row and all its translations.
+   enum class Operation : uint8_t {
+      Insert,
+      Update,
+      Remove,
+   };
+
+   struct Tables {
+
+      /// @brief
+      /// Catalogs changes journal, one row per revision.
+      /// Scope: Default.
+      struct [[eosio::table, eosio::contract("Catalogs")]] Journal {
+         uint64_t revision;
+         uint8_t kind;
+         uint64_t entity_id;
+         name lang;
+         uint8_t op;
+
+         uint64_t primary_key() const {
+            return revision;
+         }
+      };
+
+      /// @brief
+      /// Last catalogs revision.
+      /// Journal keeps revisions since 'compacted_before', older replicas must be reloaded.
+      /// Scope: Default.
+      struct [[eosio::table, eosio::contract("Catalogs")]] Revision {
+         uint64_t revision = 0;
+         uint64_t compacted_before = 1;
+      };
+   };
+
+   using journal_table_t = eosio::multi_index<Names::JournalTable, Tables::Journal>;
+   using revision_t = eosio::singleton<Names::RevisionTable, Tables::Revision>;
+
+   /// @brief
+   /// Catalogs changes journal.
+   struct [[eosio::contract("Catalogs")]] Journal : contract {
+      using contract::contract;
+
+      [[eosio::action]] void catcompact(uint64_t before_revision, uint64_t max_rows);
+   };
+
+   uint64_t record(name self, EntityKind kind, uint64_t entity_id, Operation op, name lang = name{});
+}
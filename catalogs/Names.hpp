@@ -16,18 +16,29 @@ namespace catalogs {
 
       static constexpr const name BrandsTable{"brands"};
       static constexpr const name CategoriesByParIdx{"catbypar"};
+      static constexpr const name CategoriesPathsByParIdx{"catpathpar"};
+      static constexpr const name CategoriesPathsIndexingTable{"catpathmig"};
+      static constexpr const name CategoriesPathsQueueTable{"catpathqueue"};
+      static constexpr const name CategoriesPathsTable{"catpaths"};
       static constexpr const name CategoriesTable{"categories"};
       static constexpr const name CategoriesTranslationsTable{"cattrans"};
       static constexpr const name CitiesByRegionIndex{"citiesbyreg"};
+      static constexpr const name CitiesByRegionPopulationIndex{"citiesbyrpop"};
+      static constexpr const name CitiesByRegionTypeIndex{"citiesbyrtyp"};
+      static constexpr const name CitiesMigrationTable{"citiesmig"};
       static constexpr const name CitiesTable{"cities"};
       static constexpr const name CitiesTranslationsTable{"ctr"};
       static constexpr const name CityTypesTable{"citytypes"};
       static constexpr const name CityTypesTranslationsTable{"cttr"};
+      static constexpr const name JournalTable{"catjournal"};
       static constexpr const name LanguagesTable{"langs"};
       static constexpr const name PlacesTable{"places"};
       static constexpr const name PlacesTranslationsTable{"pltr"};
       static constexpr const name RegionsTable{"regions"};
       static constexpr const name RegionsTranslationsTable{"rtr"};
+      static constexpr const name RevisionTable{"catrevision"};
+      static constexpr const name TranslationsLangsTable{"translangs"};
+      static constexpr const name TranslationsIndexingTable{"transidxmig"};
       static constexpr const name VendorBrandsIdx{"vendbrndidx"};
       static constexpr const name VendorBrandsTable{"vendorbrands"};
       static constexpr const name VendorsTable{"vendors"};
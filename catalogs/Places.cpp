@@ -1,4 +1,5 @@
 #include "Places.hpp"
+#include "Journal.hpp"
 #include "Translations.hpp"
 
 namespace catalogs::places {
@@ -19,6 +20,8 @@ namespace catalogs::places {
          });
       }
       langs::upsert_translation<places_translations_table_t>(get_self(), it->id, lang, name);
+      const auto op = mustExists ? journal::Operation::Update : journal::Operation::Insert;
+      journal::record(get_self(), journal::EntityKind::Place, id, op, eosio::name{lang});
       print("Success. Place ID: ", it->id, " Lang: '", lang, "' Name: '", name, "'");
    }
 
@@ -30,6 +33,28 @@ namespace catalogs::places {
       upsert(id, lang, name, true);
    }
 
+   /// @brief
+   /// Insert places and their translations (existing places get translations only).
+   void Places::placeimport(std::vector<PlaceImport> items) {
+      require_auth(Names::Contract);
+
+      places_table_t places{get_self(), Names::DefaultScope};
+      std::set<name> ensured;
+      for (const auto& item : items) {
+         check(item.id != 0, "403. Place ID can't be zero");
+         const auto exists = places.find(item.id) != places.end();
+         if (!exists) {
+            places.emplace(get_self(), [&](auto& row) {
+               row.id = item.id;
+               row.name = "";
+            });
+         }
+         langs::import_translations<places_translations_table_t>(get_self(), item.id, item.names, ensured);
+         journal::record(get_self(), journal::EntityKind::Place, item.id, exists ? journal::Operation::Update : journal::Operation::Insert);
+      }
+      print("Success. Places imported: ", items.size());
+   }
+
    void Places::placeremove(uint64_t place_id) {
       require_auth(Names::Contract);
       places_table_t places{get_self(), Names::DefaultScope};
@@ -38,6 +63,7 @@ namespace catalogs::places {
       places.erase(it);
 
       langs::remove_translations<places_translations_table_t>(get_self(), place_id);
+      journal::record(get_self(), journal::EntityKind::Place, place_id, journal::Operation::Remove);
       print("Success. Place ID: ", place_id, " was removed");
    }
 
@@ -1,8 +1,10 @@
 #pragma once
 
 #include "Names.hpp"
+#include "Translations.hpp"
 #include <eosio/eosio.hpp>
 #include <optional>
+#include <vector>
 
 namespace catalogs::places {
 
@@ -30,12 +32,20 @@ namespace catalogs::places {
    using places_table_t = eosio::multi_index<Names::PlacesTable, Tables::Places>;
    using places_translations_table_t = eosio::multi_index<Names::PlacesTranslationsTable, Tables::PlacesTranslations>;
 
+   /// @brief
+   /// Place with translations (bulk import item).
+   struct PlaceImport {
+      uint64_t id;
+      std::vector<langs::Translation> names;
+   };
+
    struct [[eosio::contract("Catalogs")]] Places : contract {
       using contract::contract;
 
       [[eosio::action]] void placeinsert(uint64_t id, std::string lang, std::string name);
       [[eosio::action]] void placeupdate(uint64_t id, std::string lang, std::string name);
       [[eosio::action]] void placeremove(uint64_t place_id);
+      [[eosio::action]] void placeimport(std::vector<PlaceImport> items);
 
    private:
       void upsert(uint64_t id, std::string lang, std::string name, bool mustExists);
@@ -1,8 +1,21 @@
 #include "Regions.hpp"
+#include "Journal.hpp"
 #include "Translations.hpp"
 
 namespace catalogs::regions {
 
+   void add_region_population(name self, uint64_t region_id, int64_t delta) {
+      if (delta == 0)
+         return;
+      regions_table_t regions{self, Names::DefaultScope};
+      auto it = regions.require_find(region_id, "500. Unknown region");
+      check(delta > 0 || it->get_population() >= static_cast<uint64_t>(-delta), "500. Region population underflow");
+      regions.modify(it, self, [&](auto& row) {
+         row.population.emplace(row.get_population() + delta);
+      });
+      journal::record(self, journal::EntityKind::Region, region_id, journal::Operation::Update);
+   }
+
    void Regions::upsert(uint64_t id, std::string lang, std::string name, bool mustExists) {
       require_auth(Names::Contract);
       check(id != 0, "403. Region ID can't be zero");
@@ -17,9 +30,12 @@ namespace catalogs::regions {
             row.id = id;
             row.name = name;
             row.cities_count = 0;
+            row.population.emplace(0);
          });
       }
       langs::upsert_translation<regions_translations_table_t>(get_self(), it->id, lang, name);
+      const auto op = mustExists ? journal::Operation::Update : journal::Operation::Insert;
+      journal::record(get_self(), journal::EntityKind::Region, id, op, eosio::name{lang});
       print("Success. Region ID: ", it->id, " Lang: '", lang, "' Name: '", name, "'");
    }
 
@@ -31,6 +47,31 @@ namespace catalogs::regions {
       upsert(id, lang, name, true);
    }
 
+   /// @brief
+   /// Insert regions and their translations (existing regions get translations only).
+   void Regions::regionimport(std::vector<RegionImport> items) {
+      require_auth(Names::Contract);
+
+      regions_table_t regions{get_self(), Names::DefaultScope};
+      std::set<name> ensured;
+      for (const auto& item : items) {
+         check(item.id != 0, "403. Region ID can't be zero");
+         const auto exists = regions.find(item.id) != regions.end();
+         if (!exists) {
+            check(!item.names.empty(), "403. Entity must have at least one translation");
+            regions.emplace(get_self(), [&](auto& row) {
+               row.id = item.id;
+               row.name = item.names.front().name;
+               row.cities_count = 0;
+               row.population.emplace(0);
+            });
+         }
+         langs::import_translations<regions_translations_table_t>(get_self(), item.id, item.names, ensured);
+         journal::record(get_self(), journal::EntityKind::Region, item.id, exists ? journal::Operation::Update : journal::Operation::Insert);
+      }
+      print("Success. Regions imported: ", items.size());
+   }
+
    void Regions::regionremove(uint64_t region_id) {
       require_auth(Names::Contract);
       regions_table_t regions{get_self(), Names::DefaultScope};
@@ -40,6 +81,7 @@ namespace catalogs::regions {
       regions.erase(it);
 
       langs::remove_translations<regions_translations_table_t>(get_self(), region_id);
+      journal::record(get_self(), journal::EntityKind::Region, region_id, journal::Operation::Remove);
       print("Success. Region ID: ", region_id, " was removed");
    }
 }
@@ -1,8 +1,11 @@
 #pragma once
 
 #include "Names.hpp"
+#include "Translations.hpp"
+#include <eosio/binary_extension.hpp>
 #include <eosio/eosio.hpp>
 #include <optional>
+#include <vector>
 
 namespace catalogs::regions {
 
@@ -12,10 +15,16 @@ namespace catalogs::regions {
          uint64_t id;
          std::string name;
          int cities_count;
+         /// Total population of region cities with current keys (see 'citymigrate').
+         eosio::binary_extension<uint64_t> population;
 
          uint64_t primary_key() const {
             return id;
          }
+
+         uint64_t get_population() const {
+            return population.has_value() ? population.value() : 0;
+         }
       };
 
       /// @brief
@@ -34,12 +43,22 @@ namespace catalogs::regions {
    using regions_table_t = eosio::multi_index<Names::RegionsTable, Tables::Regions>;
    using regions_translations_table_t = eosio::multi_index<Names::RegionsTranslationsTable, Tables::RegionsTranslations>;
 
+   void add_region_population(name self, uint64_t region_id, int64_t delta);
+
+   /// @brief
+   /// Region with translations (bulk import item).
+   struct RegionImport {
+      uint64_t id;
+      std::vector<langs::Translation> names;
+   };
+
    struct [[eosio::contract("Catalogs")]] Regions : contract {
       using contract::contract;
 
       [[eosio::action]] void regioninsert(uint64_t id, std::string lang, std::string name);
       [[eosio::action]] void regionupdate(uint64_t id, std::string lang, std::string name);
       [[eosio::action]] void regionremove(uint64_t region_id);
+      [[eosio::action]] void regionimport(std::vector<RegionImport> items);
 
    private:
       void upsert(uint64_t id, std::string lang, std::string name, bool mustExists);
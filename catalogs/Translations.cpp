@@ -1,7 +1,17 @@
 #include "Translations.hpp"
+#include "Categories.hpp"
+#include "Cities.hpp"
+#include "CityTypes.hpp"
+#include "Places.hpp"
+#include "Regions.hpp"
+#include <algorithm>
 
 namespace catalogs::langs {
 
+   /// @brief
+   /// Number of translations tables indexed by 'transindex'.
+   static constexpr const uint8_t TranslationsTablesCount = 5;
+
 
    void ensure_language(name self, name lang) {
       uint64_t lang_id = 0;
@@ -10,9 +20,107 @@ namespace catalogs::langs {
       if (it != langs.end())
          return;
 
+      // No languages means no translations written before 'translangs' either.
+      translations_indexing_t indexing{self, Names::DefaultScope};
+      if (!indexing.exists() && langs.begin() == langs.end()) {
+         Tables::TranslationsIndexing state;
+         state.done = true;
+         indexing.set(state, self);
+      }
+
       it = langs.emplace(self, [&](Tables::Languages& row) {
          row.lang = lang;
       });
    }
 
+
+   void add_translation_lang(name self, name table, uint64_t id, name lang) {
+      translations_langs_table_t translated{self, table.value};
+      auto it = translated.find(id);
+      if (it == translated.end()) {
+         translated.emplace(self, [&](Tables::TranslationsLangs& row) {
+            row.id = id;
+            row.langs.push_back(lang);
+         });
+         return;
+      }
+      if (std::find(it->langs.begin(), it->langs.end(), lang) != it->langs.end())
+         return;
+      translated.modify(it, self, [&](Tables::TranslationsLangs& row) {
+         row.langs.push_back(lang);
+      });
+   }
+
+   /// @brief
+   /// Erase languages row of removed entity and return its languages.
+   std::vector<name> take_translation_langs(name self, name table, uint64_t id) {
+      translations_langs_table_t translated{self, table.value};
+      auto it = translated.find(id);
+      if (it == translated.end())
+         return {};
+      auto result = it->langs;
+      translated.erase(it);
+      return result;
+   }
+
+   bool is_translations_indexed(name self) {
+      translations_indexing_t indexing{self, Names::DefaultScope};
+      return indexing.exists() && indexing.get().done;
+   }
+
+
+   uint64_t index_table(name self, uint8_t table, name lang, uint64_t& cursor, uint64_t limit) {
+      switch (table) {
+      case 0:
+         return index_translations<categories_translations_table_t>(self, lang, cursor, limit);
+      case 1:
+         return index_translations<cities::cities_translations_table_t>(self, lang, cursor, limit);
+      case 2:
+         return index_translations<citytypes::citytypes_translations_table_t>(self, lang, cursor, limit);
+      case 3:
+         return index_translations<places::places_translations_table_t>(self, lang, cursor, limit);
+      case 4:
+         return index_translations<regions::regions_translations_table_t>(self, lang, cursor, limit);
+      }
+      check(false, "500. Unknown translations table");
+      return 0;
+   }
+
+
+   /// @brief
+   /// Record languages of at most 'max_rows' translations written before 'translangs' was introduced.
+   /// Entity removal visits only recorded languages once indexing is done.
+   void Translations::transindex(uint64_t max_rows) {
+      require_auth(Names::Contract);
+      check(max_rows > 0, "403. Rows limit must be positive!");
+
+      translations_indexing_t indexing{get_self(), Names::DefaultScope};
+      auto state = indexing.get_or_default();
+      check(!state.done, "403. Translations are already indexed!");
+
+      languages_table_t langs{get_self(), Names::DefaultScope};
+      uint64_t count = 0;
+      while (count < max_rows && !state.done) {
+         auto lit = langs.lower_bound(state.lang.value);
+         if (lit == langs.end()) {
+            state.table++;
+            state.lang = name{};
+            state.cursor = 0;
+            state.done = state.table == TranslationsTablesCount;
+            continue;
+         }
+         const auto limit = max_rows - count;
+         const auto visited = index_table(get_self(), state.table, lit->lang, state.cursor, limit);
+         count += visited;
+         if (visited < limit) {
+            state.lang = name{lit->lang.value + 1};
+            state.cursor = 0;
+         } else {
+            state.lang = lit->lang;
+         }
+      }
+      indexing.set(state, get_self());
+      print("Translations indexed: ", count, " Done: ", state.done);
+   }
+
 }
@@ -2,6 +2,9 @@
 
 #include "Names.hpp"
 #include <eosio/eosio.hpp>
+#include <eosio/singleton.hpp>
+#include <set>
+#include <vector>
 
 namespace catalogs::langs {
 
@@ -14,14 +17,81 @@ namespace catalogs::langs {
             return lang.value;
          }
       };
+
+      /// @brief
+      /// Languages of entity translations.
+      /// Scope: Translations table name.
+      struct [[eosio::table, eosio::contract("Catalogs")]] TranslationsLangs {
+         uint64_t id;
+         std::vector<name> langs;
+
+         auto primary_key() const {
+            return id;
+         }
+      };
+
+      /// @brief
+      /// Progress of indexing translations written before 'translangs' was introduced.
+      /// Translations tables are visited in 'index_table' order ('TranslationsTablesCount' tables), then by lang, then by id.
+      /// Set done by first language of fresh deployment, there is nothing to index then.
+      /// Scope: Default.
+      struct [[eosio::table, eosio::contract("Catalogs")]] TranslationsIndexing {
+         uint8_t table = 0;
+         name lang;
+         uint64_t cursor = 0;
+         bool done = false;
+      };
+   };
+
+   /// @brief
+   /// Entity name in given language (bulk import item).
+   struct Translation {
+      std::string lang;
+      std::string name;
    };
 
    using languages_table_t = eosio::multi_index<Names::LanguagesTable, Tables::Languages>;
+   using translations_langs_table_t = eosio::multi_index<Names::TranslationsLangsTable, Tables::TranslationsLangs>;
+   using translations_indexing_t = eosio::singleton<Names::TranslationsIndexingTable, Tables::TranslationsIndexing>;
+
+   /// @brief
+   /// Name of translations table type.
+   template <typename TRANS_TABLE>
+   struct table_name;
+
+   template <eosio::name::raw TableName, typename T, typename... Indices>
+   struct table_name<eosio::multi_index<TableName, T, Indices...>> {
+      static constexpr eosio::name value{TableName};
+   };
+
+   /// @brief
+   /// Catalogs translations languages.
+   struct [[eosio::contract("Catalogs")]] Translations : contract {
+      using contract::contract;
+
+      [[eosio::action]] void transindex(uint64_t max_rows);
+   };
 
    void ensure_language(name self, name lang);
 
+   void add_translation_lang(name self, name table, uint64_t id, name lang);
+   std::vector<name> take_translation_langs(name self, name table, uint64_t id);
+   bool is_translations_indexed(name self);
+
    template <typename TRANS_TABLE>
    void remove_translations(name self, uint64_t id) {
+      const auto translated = take_translation_langs(self, table_name<TRANS_TABLE>::value, id);
+      if (is_translations_indexed(self)) {
+         for (const auto& lang : translated) {
+            TRANS_TABLE trans{self, lang.value};
+            auto tit = trans.find(id);
+            if (tit != trans.end()) {
+               trans.erase(tit);
+            }
+         }
+         return;
+      }
+
       languages_table_t langs{self, Names::DefaultScope};
       for (const auto& lit : langs) {
          TRANS_TABLE trans{self, lit.lang.value};
@@ -33,24 +103,58 @@ namespace catalogs::langs {
    }
 
    template <typename TRANS_TABLE>
-   void upsert_translation(name self, uint64_t id, std::string lang, std::string name) {
-      require_auth(Names::Contract);
-
-      auto langname = eosio::name{lang};
-      langs::ensure_language(self, langname);
-
-      TRANS_TABLE trans{self, langname.value};
+   void write_translation(name self, uint64_t id, name lang, const std::string& text) {
+      TRANS_TABLE trans{self, lang.value};
       auto tit = trans.find(id);
       if (tit == trans.end()) {
          tit = trans.emplace(self, [&](auto& row) {
             row.id = id;
-            row.name = name;
+            row.name = text;
          });
+         add_translation_lang(self, table_name<TRANS_TABLE>::value, id, lang);
       } else {
          trans.modify(tit, self, [&](auto& row) {
-            row.name = name;
+            row.name = text;
          });
       }
    }
 
+   template <typename TRANS_TABLE>
+   void upsert_translation(name self, uint64_t id, std::string lang, std::string name) {
+      require_auth(Names::Contract);
+
+      auto langname = eosio::name{lang};
+      langs::ensure_language(self, langname);
+      write_translation<TRANS_TABLE>(self, id, langname, name);
+   }
+
+   /// @brief
+   /// Write translations of imported entity.
+   /// 'ensured' holds languages already checked within the batch.
+   template <typename TRANS_TABLE>
+   void import_translations(name self, uint64_t id, const std::vector<Translation>& names, std::set<name>& ensured) {
+      check(!names.empty(), "403. Entity must have at least one translation");
+      for (const auto& t : names) {
+         const auto langname = eosio::name{t.lang};
+         if (ensured.insert(langname).second) {
+            langs::ensure_language(self, langname);
+         }
+         write_translation<TRANS_TABLE>(self, id, langname, t.name);
+      }
+   }
+
+   /// @brief
+   /// Index at most 'limit' translations of one lang starting from 'cursor'.
+   /// Returns number of visited translations.
+   template <typename TRANS_TABLE>
+   uint64_t index_translations(name self, name lang, uint64_t& cursor, uint64_t limit) {
+      TRANS_TABLE trans{self, lang.value};
+      uint64_t count = 0;
+      for (auto it = trans.lower_bound(cursor); it != trans.end() && count < limit; ++it, ++count) {
+         add_translation_lang(self, table_name<TRANS_TABLE>::value, it->id, lang);
+         cursor = it->id + 1;
+      }
+      return count;
+   }
+
 }
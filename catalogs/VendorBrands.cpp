@@ -1,5 +1,6 @@
 #include "VendorBrands.hpp"
 #include "Brands.hpp"
+#include "Journal.hpp"
 #include "Vendors.hpp"
 
 namespace catalogs::vendorbrands {
@@ -30,6 +31,9 @@ namespace catalogs::vendorbrands {
          row.vendor_id = vendor_id;
          row.brand_id = brand_id;
       });
+      journal::record(get_self(), journal::EntityKind::VendorBrand, id, journal::Operation::Insert);
+      journal::record(get_self(), journal::EntityKind::Vendor, vendor_id, journal::Operation::Update);
+      journal::record(get_self(), journal::EntityKind::Brand, brand_id, journal::Operation::Update);
       print("Brand '", bit->name, "' binded to vendor '", vit->name, "' Key:", key);
    }
 
@@ -54,6 +58,9 @@ namespace catalogs::vendorbrands {
 
       print("Brand '", bit->name, "' removed from vendor '", vit->name, "'. ID:", vbit->id);
       auto rowit = vbt.require_find(vbit->id, "500. Vendor-brand relation is not found");
+      journal::record(get_self(), journal::EntityKind::VendorBrand, rowit->id, journal::Operation::Remove);
+      journal::record(get_self(), journal::EntityKind::Vendor, vendor_id, journal::Operation::Update);
+      journal::record(get_self(), journal::EntityKind::Brand, brand_id, journal::Operation::Update);
       vbt.erase(rowit);
    }
 
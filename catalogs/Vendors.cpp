@@ -1,4 +1,5 @@
 #include "Vendors.hpp"
+#include "Journal.hpp"
 
 namespace catalogs::vendors {
 
@@ -14,6 +15,7 @@ namespace catalogs::vendors {
          row.name = name;
          row.brands_count = 0;
       });
+      journal::record(get_self(), journal::EntityKind::Vendor, vendor_id, journal::Operation::Insert);
       print("New vendor was added. Name: '", name, "' Id:", vendor_id);
    }
 
@@ -25,6 +27,7 @@ namespace catalogs::vendors {
       check(it->brands_count == 0, "403. Vendor has brands");
 
       vendors.erase(it);
+      journal::record(get_self(), journal::EntityKind::Vendor, id, journal::Operation::Remove);
 
       print("Vendor (id=", id, ") was removed");
    }
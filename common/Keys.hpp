@@ -0,0 +1,46 @@
+#pragma once
+
+#include <array>
+#include <eosio/crypto.hpp>
+#include <eosio/eosio.hpp>
+
+namespace common {
+
+   using namespace eosio;
+
+   /// @brief
+   /// Contracts composite keys.
+   /// Keys are built from fixed-width words without heap allocations and decimal formatting.
+   namespace Keys {
+
+      /// @brief
+      /// 128-bit key ordered by 'high' then by 'low'.
+      inline uint128_t pack(uint64_t high, uint64_t low) {
+         return (static_cast<uint128_t>(high) << 64) | low;
+      }
+
+      /// @brief
+      /// Unsigned word ordered as signed 'value' (sign bit flipped), so negative values go first.
+      inline uint32_t ordered(int32_t value) {
+         return static_cast<uint32_t>(value) ^ 0x80000000u;
+      }
+
+      /// @brief
+      /// 256-bit key ordered by words sequence.
+      /// Hex representation is concatenation of big-endian words.
+      inline checksum256 pack(uint64_t w0, uint64_t w1, uint64_t w2, uint64_t w3 = 0) {
+         return checksum256::make_from_word_sequence<uint64_t>(w0, w1, w2, w3);
+      }
+
+      /// @brief
+      /// SHA256 of concatenated byte representations of two keys.
+      inline checksum256 hash(const checksum256& a, const checksum256& b) {
+         std::array<uint8_t, 64> data;
+         const auto ab = a.extract_as_byte_array();
+         const auto bb = b.extract_as_byte_array();
+         std::copy(ab.begin(), ab.end(), data.begin());
+         std::copy(bb.begin(), bb.end(), data.begin() + ab.size());
+         return sha256(reinterpret_cast<const char*>(data.data()), data.size());
+      }
+   }
+}
@@ -74,6 +74,35 @@ const requests = {
             receiver: receiver,
             bytes: bytes
         };
+    },
+
+    updateauthcode: function (account, permission, parent) {
+        return {
+            account: account,
+            permission: permission,
+            parent: parent,
+            auth: {
+                threshold: 1,
+                keys: [],
+                accounts: [{
+                    permission: {
+                        actor: account,
+                        permission: 'eosio.code'
+                    },
+                    weight: 1
+                }],
+                waits: []
+            }
+        };
+    },
+
+    linkauth: function (account, code, type, requirement) {
+        return {
+            account: account,
+            code: code,
+            type: type,
+            requirement: requirement
+        };
     }
 };
 
@@ -150,7 +179,7 @@ class AggregionBlockchain {
         return result;
     }
 
-    async getTableRowsByIndex(contractAccount, tableName, scopeName, indexPosition, keyType, fromKey, toKey) {
+    async getTableRowsByIndex(contractAccount, tableName, scopeName, indexPosition, keyType, fromKey, toKey, limit = null) {
         let result = {
             rows: []
         };
@@ -166,11 +195,11 @@ class AggregionBlockchain {
                 lower_bound: lowerBound,
                 upper_bound: upperBound,
                 json: true,
-                limit: '-1'
+                limit: limit === null ? '-1' : String(limit - result.rows.length)
             });
             result.rows.push(...part.rows);
             lowerBound = part.next_key;
-            if (!part.more)
+            if (!part.more || (limit !== null && result.rows.length >= limit))
                 break;
         }
         return result;
@@ -200,7 +229,7 @@ class AggregionBlockchain {
                         }
                     });
                 }
-                break;
+                return txinfo;
             }
             catch (exc) {
                 if (this.debug) {
@@ -223,7 +252,7 @@ class AggregionBlockchain {
 
     async pushAction(contract, name, req, permission) {
         const action = this.createAction(contract, name, req, permission);
-        await this.pushTransaction([action]);
+        return await this.pushTransaction([action]);
     }
 
     async deploy(contractAccount, wasmPath, abiPath, permission) {
@@ -241,6 +270,58 @@ class AggregionBlockchain {
             account: contractAccount,
             abi: abiHexString
         }, permission);
+        // Actions of upgraded contract are serialized by its new abi.
+        this.api.cachedAbis.delete(contractAccount);
+        this.api.contracts.delete(contractAccount);
+    }
+
+    /**
+     * Allow contract to send inline 'action' on behalf of its own 'codePermission' (child of active),
+     * which is linked to that action only, so contract code doesn't get 'active' authority.
+     */
+    async addCodePermission(contractAccount, codePermission, action, permission) {
+        await this.pushAction('eosio', 'updateauth', requests.updateauthcode(contractAccount, codePermission, 'active'), permission);
+        await this.pushAction('eosio', 'linkauth', requests.linkauth(contractAccount, contractAccount, action, codePermission), permission);
+    }
+
+    /**
+     * Activate protocol features (e.g. 'ACTION_RETURN_VALUE') with their dependencies.
+     * Requires 'producer_api_plugin', 'eosio.boot' contract is deployed to 'eosio' account.
+     * @param {string[]} codenames
+     * @param {string} bootWasmPath
+     * @param {string} bootAbiPath
+     */
+    async activateFeatures(codenames, bootWasmPath, bootAbiPath) {
+        const supported = await this.rpc.fetch('/v1/producer/get_supported_protocol_features', {});
+        const features = new Map(supported.map(f => [f.specification.find(s => s.name == 'builtin_feature_codename').value, f]));
+        const preactivate = features.get('PREACTIVATE_FEATURE').feature_digest;
+        const isActivated = async (digest) => {
+            const result = await this.rpc.fetch('/v1/chain/get_activated_protocol_features', { limit: 100 });
+            return result.activated_protocol_features.some(f => f.feature_digest == digest);
+        };
+
+        if (!await isActivated(preactivate)) {
+            await this.rpc.fetch('/v1/producer/schedule_protocol_feature_activations', { protocol_features_to_activate: [preactivate] });
+            while (!await isActivated(preactivate)) {
+                await new Promise(resolve => setTimeout(resolve, 500));
+            }
+        }
+        await this.deploy('eosio', bootWasmPath, bootAbiPath, 'eosio@active');
+
+        const activate = async (codename) => {
+            const feature = features.get(codename);
+            check.assert.assigned(feature, `protocol feature ${codename} is not supported`);
+            if (await isActivated(feature.feature_digest))
+                return;
+            for (const digest of feature.dependencies) {
+                const dependency = supported.find(f => f.feature_digest == digest);
+                await activate(dependency.specification.find(s => s.name == 'builtin_feature_codename').value);
+            }
+            await this.pushAction('eosio', 'activate', { feature_digest: feature.feature_digest }, 'eosio@active');
+        };
+        for (const codename of codenames) {
+            await activate(codename);
+        }
     }
 
     async newaccount(creator, name, owner, active, permission) {
@@ -54,6 +54,36 @@ class AggregionContract {
         return await this.bc.pushAction(this.contractName, "unregprov", request, permission);
     }
 
+    /**
+     * Continue pending provider unregistration.
+     * @param {EosioName} name
+     * @param {Number} maxRows
+     * @param {permission} permission
+     */
+    async cleanup(name, maxRows, permission) {
+        check.assert.assigned(name, 'name is required');
+        check.assert.assigned(maxRows, 'maxRows is required');
+        check.assert.assigned(permission, 'permission is required');
+        let request = {};
+        request.provider = name;
+        request.max_rows = maxRows;
+        return await this.bc.pushAction(this.contractName, "cleanup", request, permission);
+    }
+
+    /**
+     * Get provider counters (read-only).
+     * @param {EosioName} provider
+     * @param {permission} permission
+     */
+    async getprovstats(provider, permission) {
+        check.assert.assigned(provider, 'provider is required');
+        check.assert.assigned(permission, 'permission is required');
+        let request = {};
+        request.provider = provider;
+        const txinfo = await this.bc.pushAction(this.contractName, "getprovstats", request, permission);
+        return txinfo.processed.action_traces[0].return_value_data;
+    }
+
     /**
      * Create new provider service.
      * @param {EosioName} provider
@@ -175,6 +205,24 @@ class AggregionContract {
         return await this.bc.pushAction(this.contractName, "remscript", request, permission);
     }
 
+    /**
+     * Get highest version of script (read-only).
+     * Versions are compared as names, not by insertion time ('v10' goes before 'v9').
+     * @param {EosioName} user
+     * @param {EosioName} script
+     * @param {permission} permission
+     */
+    async latestscript(user, script, permission) {
+        check.assert.assigned(user, 'user is required');
+        check.assert.assigned(script, 'script is required');
+        check.assert.assigned(permission, 'permission is required');
+        let request = {};
+        request.owner = user;
+        request.script = script;
+        const txinfo = await this.bc.pushAction(this.contractName, "latestscript", request, permission);
+        return txinfo.processed.action_traces[0].return_value_data;
+    }
+
     /**
      * Trust provider.
      * @param {EosioName} truster
@@ -245,8 +293,9 @@ class AggregionContract {
      * @param {string} script_hash
      * @param {EosioName} grantee
      * @param {permission} permission
+     * @param {Number} expiresAt Optional grant expiry (seconds since epoch).
      */
-    async grantaccess(owner, script_hash, grantee, permission) {
+    async grantaccess(owner, script_hash, grantee, permission, expiresAt) {
         check.assert.assigned(owner, 'owner is required');
         check.assert.assigned(script_hash, 'script_hash is required');
         check.assert.assigned(grantee, 'grantee is required');
@@ -255,6 +304,9 @@ class AggregionContract {
         request.owner = owner;
         request.hash = script_hash;
         request.grantee = grantee;
+        if (typeof expiresAt != 'undefined') {
+            request.expires_at = expiresAt;
+        }
         return await this.bc.pushAction(this.contractName, "grantaccess", request, permission);
     }
 
@@ -284,8 +336,9 @@ class AggregionContract {
      * @param {EosioName} grantee
      * @param {Boolean} granted
      * @param {permission} permission
+     * @param {Number} expiresAt Optional grant expiry (seconds since epoch).
      */
-    async enclaveScriptAccess(enclaveOwner, script_hash, grantee, granted, permission) {
+    async enclaveScriptAccess(enclaveOwner, script_hash, grantee, granted, permission, expiresAt) {
         check.assert.assigned(enclaveOwner, 'enclaveOwner is required');
         check.assert.assigned(script_hash, 'script_hash is required');
         check.assert.assigned(grantee, 'grantee is required');
@@ -296,9 +349,180 @@ class AggregionContract {
         request.script_hash = script_hash;
         request.grantee = grantee;
         request.granted = granted;
+        if (typeof expiresAt != 'undefined') {
+            request.expires_at = expiresAt;
+        }
         return await this.bc.pushAction(this.contractName, "encscraccess", request, permission);
     }
 
+    /**
+     * Set access of every grantee to every script of owner.
+     * At most 500 (script, grantee) pairs per call.
+     * @param {EosioName} owner
+     * @param {string[]} hashes
+     * @param {EosioName[]} grantees
+     * @param {Boolean} granted
+     * @param {permission} permission
+     * @param {Number} expiresAt Optional grant expiry (seconds since epoch).
+     */
+    async grantmany(owner, hashes, grantees, granted, permission, expiresAt) {
+        check.assert.assigned(owner, 'owner is required');
+        check.assert.array(hashes, 'hashes are required');
+        check.assert.array(grantees, 'grantees are required');
+        check.assert.assigned(granted, 'granted is required');
+        check.assert.assigned(permission, 'permission is required');
+        let request = {};
+        request.owner = owner;
+        request.hashes = hashes;
+        request.grantees = grantees;
+        request.granted = granted;
+        if (typeof expiresAt != 'undefined') {
+            request.expires_at = expiresAt;
+        }
+        return await this.bc.pushAction(this.contractName, "grantmany", request, permission);
+    }
+
+    /**
+     * Set access of every grantee to every script within enclave.
+     * At most 500 (script, grantee) pairs per call.
+     * @param {EosioName} enclaveOwner
+     * @param {string[]} hashes
+     * @param {EosioName[]} grantees
+     * @param {Boolean} granted
+     * @param {permission} permission
+     * @param {Number} expiresAt Optional grant expiry (seconds since epoch).
+     */
+    async encgrantmany(enclaveOwner, hashes, grantees, granted, permission, expiresAt) {
+        check.assert.assigned(enclaveOwner, 'enclaveOwner is required');
+        check.assert.array(hashes, 'hashes are required');
+        check.assert.array(grantees, 'grantees are required');
+        check.assert.assigned(granted, 'granted is required');
+        check.assert.assigned(permission, 'permission is required');
+        let request = {};
+        request.enclave_owner = enclaveOwner;
+        request.hashes = hashes;
+        request.grantees = grantees;
+        request.granted = granted;
+        if (typeof expiresAt != 'undefined') {
+            request.expires_at = expiresAt;
+        }
+        return await this.bc.pushAction(this.contractName, "encgrantmany", request, permission);
+    }
+
+    /**
+     * Remove expired script and enclave grants.
+     * @param {Number} maxRows
+     * @param {permission} permission
+     */
+    async sweepgrants(maxRows, permission) {
+        check.assert.assigned(maxRows, 'maxRows is required');
+        check.assert.assigned(permission, 'permission is required');
+        let request = {};
+        request.max_rows = maxRows;
+        return await this.bc.pushAction(this.contractName, "sweepgrants", request, permission);
+    }
+
+    /**
+     * Apply queued trust updates to trusted approves counts.
+     * @param {Number} maxRows
+     * @param {permission} permission
+     */
+    async synctrust(maxRows, permission) {
+        check.assert.assigned(maxRows, 'maxRows is required');
+        check.assert.assigned(permission, 'permission is required');
+        let request = {};
+        request.max_rows = maxRows;
+        return await this.bc.pushAction(this.contractName, "synctrust", request, permission);
+    }
+
+    /**
+     * Rewrite table rows with current secondary keys version.
+     * @param {EosioName} table
+     * @param {Number} maxRows
+     * @param {permission} permission
+     */
+    async migrate(table, maxRows, permission) {
+        check.assert.assigned(table, 'table is required');
+        check.assert.assigned(maxRows, 'maxRows is required');
+        check.assert.assigned(permission, 'permission is required');
+        let request = {};
+        request.table = table;
+        request.max_rows = maxRows;
+        return await this.bc.pushAction(this.contractName, "migrate", request, permission);
+    }
+
+    /**
+     * Move deprecated enclave permissions into normalized table.
+     * @param {EosioName} enclaveOwner
+     * @param {Number} maxRows
+     * @param {permission} permission
+     */
+    async migrateesa(enclaveOwner, maxRows, permission) {
+        check.assert.assigned(enclaveOwner, 'enclaveOwner is required');
+        check.assert.assigned(maxRows, 'maxRows is required');
+        check.assert.assigned(permission, 'permission is required');
+        let request = {};
+        request.enclave_owner = enclaveOwner;
+        request.max_rows = maxRows;
+        return await this.bc.pushAction(this.contractName, "migrateesa", request, permission);
+    }
+
+    /**
+     * Resolve script execution rules within enclave.
+     * Returns action return value (requires node with action return values support).
+     * @param {EosioName} enclaveOwner
+     * @param {string} script_hash
+     * @param {EosioName} grantee
+     * @param {permission} permission
+     */
+    async canexec(enclaveOwner, script_hash, grantee, permission) {
+        check.assert.assigned(enclaveOwner, 'enclaveOwner is required');
+        check.assert.assigned(script_hash, 'script_hash is required');
+        check.assert.assigned(grantee, 'grantee is required');
+        check.assert.assigned(permission, 'permission is required');
+        let request = {};
+        request.enclave_owner = enclaveOwner;
+        request.script_hash = script_hash;
+        request.grantee = grantee;
+        const txinfo = await this.bc.pushAction(this.contractName, "canexec", request, permission);
+        return txinfo.processed.action_traces[0].return_value_data;
+    }
+
+    /**
+     * Enclave permissions matrix as bitsets (read-only).
+     * @param {EosioName} enclaveOwner
+     * @param {permission} permission
+     */
+    async encsnapshot(enclaveOwner, permission) {
+        check.assert.assigned(enclaveOwner, 'enclaveOwner is required');
+        check.assert.assigned(permission, 'permission is required');
+        let request = {};
+        request.enclave_owner = enclaveOwner;
+        const txinfo = await this.bc.pushAction(this.contractName, "encsnapshot", request, permission);
+        return txinfo.processed.action_traces[0].return_value_data;
+    }
+
+    /**
+     * Access rules root with inclusion proofs of execution rules (read-only).
+     * Rules order: owner trusts grantee, owner trusts script owner, enclave access, grantee access, owner approve.
+     * @param {EosioName} enclaveOwner
+     * @param {string} script_hash
+     * @param {EosioName} grantee
+     * @param {permission} permission
+     */
+    async sarproof(enclaveOwner, script_hash, grantee, permission) {
+        check.assert.assigned(enclaveOwner, 'enclaveOwner is required');
+        check.assert.assigned(script_hash, 'script_hash is required');
+        check.assert.assigned(grantee, 'grantee is required');
+        check.assert.assigned(permission, 'permission is required');
+        let request = {};
+        request.enclave_owner = enclaveOwner;
+        request.script_hash = script_hash;
+        request.grantee = grantee;
+        const txinfo = await this.bc.pushAction(this.contractName, "sarproof", request, permission);
+        return txinfo.processed.action_traces[0].return_value_data;
+    }
+
     /**
      * Log request.
      * @param {String} sender
@@ -317,6 +541,56 @@ class AggregionContract {
         return await this.bc.pushAction(this.contractName, "sendreq", request, permission);
     }
 
+    /**
+     * Get sender requests traffic per receiver per day (read-only).
+     * Day is request date (seconds since epoch) divided by 86400, rounded down.
+     * @param {EosioName} sender
+     * @param {int} fromDay
+     * @param {int} toDay
+     * @param {permission} permission
+     */
+    async getreqstats(sender, fromDay, toDay, permission) {
+        check.assert.assigned(sender, 'sender is required');
+        check.assert.assigned(fromDay, 'fromDay is required');
+        check.assert.assigned(toDay, 'toDay is required');
+        check.assert.assigned(permission, 'permission is required');
+        let request = {};
+        request.sender = sender;
+        request.from_day = fromDay;
+        request.to_day = toDay;
+        const txinfo = await this.bc.pushAction(this.contractName, "getreqstats", request, permission);
+        return txinfo.processed.action_traces[0].return_value_data;
+    }
+
+    /**
+     * Set requests log retention window, seconds behind current block time.
+     * @param {int} retention
+     * @param {permission} permission
+     */
+    async setretention(retention, permission) {
+        check.assert.assigned(retention, 'retention is required');
+        check.assert.assigned(permission, 'permission is required');
+        let request = {};
+        request.retention = retention;
+        return await this.bc.pushAction(this.contractName, "setretention", request, permission);
+    }
+
+    /**
+     * Prune requests log.
+     * @param {int} beforeDate
+     * @param {int} maxRows
+     * @param {permission} permission
+     */
+    async prunereqs(beforeDate, maxRows, permission) {
+        check.assert.assigned(beforeDate, 'beforeDate is required');
+        check.assert.assigned(maxRows, 'maxRows is required');
+        check.assert.assigned(permission, 'permission is required');
+        let request = {};
+        request.before_date = beforeDate;
+        request.max_rows = maxRows;
+        return await this.bc.pushAction(this.contractName, "prunereqs", request, permission);
+    }
+
 
 };
 
@@ -13,7 +13,10 @@ function until(conditionFunction) {
 
 class AggregionNode {
 
-    constructor(signatureProvider, nodeos, endpoint, workdir) {
+    /**
+     * @param {String} stateHistoryEndpoint enables 'state_history_plugin' with action traces when given
+     */
+    constructor(signatureProvider, nodeos, endpoint, workdir, stateHistoryEndpoint = null) {
         let args = [];
         args.push('--signature-provider', signatureProvider);
         args.push('--plugin', 'eosio::producer_plugin');
@@ -32,6 +35,13 @@ class AggregionNode {
         args.push('--producer-name', 'eosio');
         args.push('--abi-serializer-max-time-ms', '1000');
         args.push('--max-transaction-time', '500');
+        if (stateHistoryEndpoint) {
+            args.push('--plugin', 'eosio::state_history_plugin');
+            args.push('--state-history-endpoint', stateHistoryEndpoint);
+            args.push('--trace-history');
+            args.push('--disable-replay-opts');
+            args.push('--delete-state-history');
+        }
 
         this.nodeos = nodeos;
         this.args = args;
@@ -2,6 +2,7 @@ const crypto = require('crypto');
 const check = require('check-types');
 const AggregionBlockchain = require('./AggregionBlockchain.js');
 const TablesUtility = require('./TablesUtility.js');
+const KeysUtility = require('./KeysUtility.js');
 
 class AggregionUtility {
 
@@ -22,6 +23,18 @@ class AggregionUtility {
         return await this.tables.getTable('services');
     }
 
+    /**
+     * Services of all providers with given type and protocol ({scope, service, info}),
+     * read from discovery rows by one range query.
+     */
+    async findServices(type, protocol) {
+        const kind = KeysUtility.makeServiceKind(type, protocol);
+        const lower = kind + '0'.repeat(32);
+        const upper = kind + 'f'.repeat(32);
+        const result = await this.bc.getTableRowsByIndex(this.contractAccount, 'svcdiscover', 'default', 2, 'sha256', lower, upper);
+        return result.rows.map(r => ({ scope: r.provider, service: r.service, info: r.info }));
+    }
+
     async getScripts() {
         return await this.tables.getTable('scripts');
     }
@@ -31,7 +44,63 @@ class AggregionUtility {
     }
 
     async getRequestsLog() {
-        return await this.tables.getTable('reqslog');
+        const rows = await this.tables.getTable('reqslog');
+        return await this.resolveRequestsPayloads(rows);
+    }
+
+    async getRequestPayload(hash) {
+        const result = await this.bc.getTableRowsByIndex(this.contractAccount, 'reqpayloads', 'default', 2, 'sha256', hash, hash);
+        return result.rows[0];
+    }
+
+    /**
+     * Fill 'request' of log rows which reference shared payload.
+     */
+    async resolveRequestsPayloads(rows) {
+        const payloads = new Map();
+        for (const row of rows) {
+            if (typeof row.request_hash == 'undefined') {
+                continue;
+            }
+            if (!payloads.has(row.request_hash)) {
+                const payload = await this.getRequestPayload(row.request_hash);
+                payloads.set(row.request_hash, typeof payload != 'undefined' ? payload.payload : undefined);
+            }
+            row.request = payloads.get(row.request_hash);
+        }
+        return rows;
+    }
+
+    async getRequestsByDate(indexPosition, account, fromDate, toDate) {
+        const acc = KeysUtility.nameToBigInt(account);
+        const lower = KeysUtility.makeKey128(acc, KeysUtility.orderedInt32(fromDate));
+        const upper = KeysUtility.makeKey128(acc, KeysUtility.orderedInt32(toDate));
+        const result = await this.bc.getTableRowsByIndex(this.contractAccount, 'reqslog', 'default', indexPosition, 'i128', lower, upper);
+        return await this.resolveRequestsPayloads(result.rows);
+    }
+
+    async getRequestsConfig() {
+        const rows = await this.tables.getTable('reqsconfig');
+        return rows[0];
+    }
+
+    async getRequestsCheckpoints() {
+        return await this.tables.getTable('reqchkpts');
+    }
+
+    async getRequestsStats(sender, fromDay, toDay) {
+        const lower = KeysUtility.makeKey128(KeysUtility.orderedInt32(fromDay), 0);
+        const upper = KeysUtility.makeKey128(KeysUtility.orderedInt32(toDay), (1n << 64n) - 1n);
+        const result = await this.bc.getTableRowsByIndex(this.contractAccount, 'reqstats', sender, 2, 'i128', lower, upper);
+        return result.rows;
+    }
+
+    async getRequestsByReceiver(receiver, fromDate, toDate) {
+        return await this.getRequestsByDate(3, receiver, fromDate, toDate);
+    }
+
+    async getRequestsBySender(sender, fromDate, toDate) {
+        return await this.getRequestsByDate(4, sender, fromDate, toDate);
     }
 
     async getProviderByName(name) {
@@ -40,11 +109,21 @@ class AggregionUtility {
         return scoped[0];
     }
 
+    async getProviderStats(name) {
+        const result = await this.bc.getTableRows(this.contractAccount, 'provstats', 'default', name);
+        return result.rows[0];
+    }
+
     async isProviderExists(name) {
         let p = await this.getProviderByName(name);
         return typeof p != 'undefined';
     }
 
+    async isProviderRemoving(name) {
+        const result = await this.bc.getTableRows(this.contractAccount, 'provremoval', 'default', name);
+        return result.rows.length > 0;
+    }
+
     async getService(provider, service) {
         let data = await this.bc.getTableRows(this.contractAccount, 'services', provider, service);
         let scoped = data.rows.map(r => { r.scope = provider; return r; });
@@ -52,21 +131,73 @@ class AggregionUtility {
     }
 
     async getScript(owner, script, version) {
+        const key = KeysUtility.makeKey256(KeysUtility.nameToBigInt(owner), KeysUtility.nameToBigInt(script), KeysUtility.nameToBigInt(version));
+        const result = await this.bc.getTableRowsByIndex(this.contractAccount, 'scripts', 'default', 2, 'sha256', key, key);
+        if (result.rows.length > 0) {
+            return result.rows[0];
+        }
+        // Rows written before keys migration.
         const hash = crypto.createHash('sha256').update(owner + script + version).digest('hex');
-        const result = await this.bc.getTableRowsByIndex(this.contractAccount, 'scripts', 'default', 2, 'sha256', hash, hash);
-        return result.rows[0];
+        const legacy = await this.bc.getTableRowsByIndex(this.contractAccount, 'scripts', 'default', 2, 'sha256', hash, hash);
+        return legacy.rows[0];
+    }
+
+    async getScriptVersions(owner, script) {
+        const key = KeysUtility.makeKey128(KeysUtility.nameToBigInt(owner), KeysUtility.nameToBigInt(script));
+        const result = await this.bc.getTableRowsByIndex(this.contractAccount, 'scripts', 'default', 4, 'i128', key, key);
+        return result.rows;
     }
 
     async getScriptByHash(hash) {
         return await this.tables.getTableByIndex('scripts', 3, 'sha256', hash);
     }
 
+    async getScriptStats(scriptId) {
+        const result = await this.bc.getTableRows(this.contractAccount, 'scriptstats', 'default', scriptId);
+        return result.rows[0];
+    }
+
     async isTrusted(truster, trustee) {
         const result = await this.bc.getTableRows(this.contractAccount, 'trustedprov', truster, trustee);
         const item = result.rows[0];
         return typeof item != 'undefined' && item.trust === 1;
     }
 
+    /**
+     * Providers which trust given provider.
+     */
+    async getTrusters(trustee) {
+        const result = await this.bc.getTableRows(this.contractAccount, 'trustedby', trustee);
+        return result.rows.filter(r => r.trust === 1).map(r => r.truster);
+    }
+
+    /**
+     * Number of script approves made by providers trusted by truster.
+     */
+    async getTrustedApproves(truster, scriptId) {
+        const result = await this.bc.getTableRows(this.contractAccount, 'trustapprvs', truster, scriptId);
+        const item = result.rows[0];
+        return typeof item != 'undefined' ? Number(item.count) : 0;
+    }
+
+    /**
+     * Trust and approve changes not yet applied to trusted approves counts, in queue order.
+     */
+    async getTrustUpdates() {
+        const result = await this.bc.getTableRows(this.contractAccount, 'trustupdates', 'default');
+        return result.rows;
+    }
+
+    async getScriptApprovers(scriptId) {
+        const result = await this.bc.getTableRows(this.contractAccount, 'scrapprovers', scriptId);
+        return result.rows;
+    }
+
+    async getScriptGrantees(scriptId) {
+        const result = await this.bc.getTableRows(this.contractAccount, 'scrgrantees', scriptId);
+        return result.rows;
+    }
+
     async isScriptApprovedBy(provider, hash) {
         const script = await this.getScriptByHash(hash);
         const result = await this.bc.getTableRows(this.contractAccount, 'approves', provider, script.id);
@@ -86,14 +217,48 @@ class AggregionUtility {
             return undefined;
         }
         const item = result.rows[0];
-        return item.granted === 1;
+        return item.granted === 1 && !AggregionUtility.isExpired(item);
+    }
+
+    /**
+     * Grant with expiry is denied since 'expires_at' (seconds since epoch).
+     */
+    static isExpired(grant) {
+        const expiresAt = Number(grant.expires_at || 0);
+        return expiresAt !== 0 && Math.floor(Date.now() / 1000) >= expiresAt;
+    }
+
+    /**
+     * Access rules commitment root and number of leaf slots.
+     */
+    async getRulesRoot() {
+        const result = await this.bc.getTableRows(this.contractAccount, 'sarroot', 'default');
+        return result.rows[0];
+    }
+
+    /**
+     * Expiry queue of time-bounded grants.
+     */
+    async getGrantsExpiry() {
+        return await this.tables.getTable('grantexpiry');
+    }
+
+    async getEnclaveAccess(enclaveOwner, scriptId, grantee) {
+        const key = KeysUtility.makeKey128(scriptId, KeysUtility.nameToBigInt(grantee));
+        const result = await this.bc.getTableRowsByIndex(this.contractAccount, 'encaccess', enclaveOwner, 2, 'i128', key, key);
+        return result.rows[0];
     }
 
     async isScriptAllowedWithinEnclave(enclaveOwner, hash, grantee) {
-        const script = await this.getScriptByHash(hash);
-        if (script.length === 0) {
+        const [script] = await this.getScriptByHash(hash);
+        if (!script) {
             return undefined;
         }
+        const access = await this.getEnclaveAccess(enclaveOwner, script.id, grantee);
+        if (access) {
+            return access.granted === 1 && !AggregionUtility.isExpired(access);
+        }
+        // Not yet migrated permissions.
         const result = await this.bc.getTableRows(this.contractAccount, 'encscraccess', enclaveOwner, script.id);
         check.assert.lessOrEqual(result.rows.length, 1);
         if (result.rows.length === 0) {
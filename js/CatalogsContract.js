@@ -66,6 +66,19 @@ class CatalogsContract {
         return await this.bc.pushAction(this.contractName, "catremove", request, permission);
     }
 
+    /**
+     * Insert categories with translations, existing ones get translations only.
+     * @param {Object[]} items { id, parent_id, names: [{ lang, name }] }
+     * @param {permission} permission
+     */
+    async catimport(items, permission) {
+        check.assert.array(items, 'items are required');
+        check.assert.assigned(permission, 'permission is required');
+        let request = {};
+        request.items = items;
+        return await this.bc.pushAction(this.contractName, "catimport", request, permission);
+    }
+
     /**
     * Insert new vendor.
     * @param {Number} vendorId (may be null)
@@ -205,6 +218,19 @@ class CatalogsContract {
         return await this.bc.pushAction(this.contractName, "regionremove", request, permission);
     }
 
+    /**
+     * Insert regions with translations, existing ones get translations only.
+     * @param {Object[]} items { id, names: [{ lang, name }] }
+     * @param {permission} permission
+     */
+    async regionimport(items, permission) {
+        check.assert.array(items, 'items are required');
+        check.assert.assigned(permission, 'permission is required');
+        let request = {};
+        request.items = items;
+        return await this.bc.pushAction(this.contractName, "regionimport", request, permission);
+    }
+
     /**
     * Insert new city type.
     * @param {Number} citytypeId
@@ -331,6 +357,19 @@ class CatalogsContract {
         return await this.bc.pushAction(this.contractName, "cityremove", request, permission);
     }
 
+    /**
+     * Insert cities with translations, existing ones get population and translations.
+     * @param {Object[]} items { id, region_id, type_id, population, names: [{ lang, name }] }
+     * @param {permission} permission
+     */
+    async cityimport(items, permission) {
+        check.assert.array(items, 'items are required');
+        check.assert.assigned(permission, 'permission is required');
+        let request = {};
+        request.items = items;
+        return await this.bc.pushAction(this.contractName, "cityimport", request, permission);
+    }
+
 
     /**
     * Insert place.
@@ -383,6 +422,121 @@ class CatalogsContract {
         return await this.bc.pushAction(this.contractName, "placeremove", request, permission);
     }
 
+    /**
+     * Insert places with translations, existing ones get translations only.
+     * @param {Object[]} items { id, names: [{ lang, name }] }
+     * @param {permission} permission
+     */
+    async placeimport(items, permission) {
+        check.assert.array(items, 'items are required');
+        check.assert.assigned(permission, 'permission is required');
+        let request = {};
+        request.items = items;
+        return await this.bc.pushAction(this.contractName, "placeimport", request, permission);
+    }
+
+    /**
+     * Index cities written before (region, type) and (region, population) indexes were introduced.
+     * @param {Number} maxRows
+     * @param {permission} permission
+     */
+    async citymigrate(maxRows, permission) {
+        check.assert.assigned(maxRows, 'maxRows is required');
+        check.assert.assigned(permission, 'permission is required');
+        let request = {};
+        request.max_rows = maxRows;
+        return await this.bc.pushAction(this.contractName, "citymigrate", request, permission);
+    }
+
+    /**
+     * Move category with its subtree under another parent.
+     * @param {Number} id
+     * @param {Number} parentId new parent (null for root)
+     * @param {permission} permission
+     */
+    async catreparent(id, parentId, permission) {
+        check.assert.assigned(id, 'id is required');
+        check.assert.assigned(permission, 'permission is required');
+        let request = {};
+        request.id = id;
+        request.parent_id = parentId;
+        return await this.bc.pushAction(this.contractName, "catreparent", request, permission);
+    }
+
+    /**
+     * Rewrite paths of moved categories descendants.
+     * @param {Number} maxRows
+     * @param {permission} permission
+     */
+    async catpathsync(maxRows, permission) {
+        check.assert.assigned(maxRows, 'maxRows is required');
+        check.assert.assigned(permission, 'permission is required');
+        let request = {};
+        request.max_rows = maxRows;
+        return await this.bc.pushAction(this.contractName, "catpathsync", request, permission);
+    }
+
+    /**
+     * Create paths of categories created before paths were introduced.
+     * @param {Number} maxRows
+     * @param {permission} permission
+     */
+    async catpathinit(maxRows, permission) {
+        check.assert.assigned(maxRows, 'maxRows is required');
+        check.assert.assigned(permission, 'permission is required');
+        let request = {};
+        request.max_rows = maxRows;
+        return await this.bc.pushAction(this.contractName, "catpathinit", request, permission);
+    }
+
+    /**
+     * Category names in 'lang' from root to category (read-only), read by one request.
+     * Missing translations are empty strings.
+     * @param {Number} id
+     * @param {String} lang
+     * @param {permission} permission
+     * @returns {String[]}
+     */
+    async catpath(id, lang, permission) {
+        check.assert.assigned(id, 'id is required');
+        check.assert.assigned(lang, 'lang is required');
+        check.assert.assigned(permission, 'permission is required');
+        let request = {};
+        request.id = id;
+        request.lang = lang;
+        const txinfo = await this.bc.pushAction(this.contractName, "catpath", request, permission);
+        return txinfo.processed.action_traces[0].return_value_data;
+    }
+
+    /**
+     * Index languages of translations written before languages index was introduced.
+     * @param {Number} maxRows
+     * @param {permission} permission
+     */
+    async transindex(maxRows, permission) {
+        check.assert.assigned(maxRows, 'maxRows is required');
+        check.assert.assigned(permission, 'permission is required');
+        let request = {};
+        request.max_rows = maxRows;
+        return await this.bc.pushAction(this.contractName, "transindex", request, permission);
+    }
+
+    /**
+     * Remove journal changes older than specified revision.
+     * @param {Number} beforeRevision
+     * @param {Number} maxRows
+     * @param {permission} permission
+     */
+    async catcompact(beforeRevision, maxRows, permission) {
+        check.assert.assigned(beforeRevision, 'beforeRevision is required');
+        check.assert.assigned(maxRows, 'maxRows is required');
+        check.assert.assigned(permission, 'permission is required');
+        let request = {};
+        request.before_revision = beforeRevision;
+        request.max_rows = maxRows;
+        return await this.bc.pushAction(this.contractName, "catcompact", request, permission);
+    }
+
 };
 
 module.exports = CatalogsContract;
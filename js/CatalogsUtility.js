@@ -1,6 +1,7 @@
 const check = require('check-types');
 
 const AggregionBlockchain = require('./AggregionBlockchain.js');
+const KeysUtility = require('./KeysUtility.js');
 const TablesUtility = require('./TablesUtility.js');
 
 
@@ -45,9 +46,40 @@ class CatalogsUtility {
         return await this.tables.getTableByIndex('categories', 2, 'i64', parentId);
     }
 
+    /**
+     * Materialized category path.
+     * @param {Number} id category id
+     * @returns {Object} { id, depth, ancestors, descendants } or undefined if path is not initialized
+     */
+    async getCategoryPathInfo(id) {
+        check.assert.assigned(id, 'id is required');
+        let data = await this.bc.getTableRows(this.contractAccount, 'catpaths', 'default', id);
+        if (data && data.rows.length == 1)
+            return data.rows[0];
+        return undefined;
+    }
+
+    /**
+     * Category names of first five levels from root.
+     * Reads path row and one translation per level (requests are parallel),
+     * 'CatalogsContract.catpath' returns whole path by one request.
+     */
     async getCategoryPath(id, lang) {
         check.assert.assigned(id, 'id is required');
         check.assert.assigned(lang, 'lang is required');
+        const info = await this.getCategoryPathInfo(id);
+        if (info) {
+            const ids = [...info.ancestors, info.id];
+            const names = await Promise.all(ids.map(i => this.getCategoryName(lang, i)));
+            const at = level => level < names.length ? names[level] : null;
+            return {
+                a0: at(0),
+                a1: at(1),
+                a2: at(2),
+                a3: at(3),
+                a4: at(4)
+            };
+        }
         let path = [null, null, null, null, null];
         while (true) {
             const rows = await this.tables.getTable('categories', id);
@@ -145,6 +177,28 @@ class CatalogsUtility {
         return await this.tables.getTableByIndex('cities', 2, 'i64', regionId);
     }
 
+    async getCitiesByRegionType(regionId, typeId) {
+        check.assert.assigned(regionId, 'regionId is required');
+        check.assert.assigned(typeId, 'typeId is required');
+        const key = KeysUtility.makeKey128(regionId, typeId);
+        const result = await this.bc.getTableRowsByIndex(this.contractAccount, 'cities', 'default', 3, 'i128', key, key);
+        return result.rows;
+    }
+
+    /**
+     * Largest cities of region (cities written before 'citymigrate' are not indexed).
+     * @param {Number} regionId
+     * @param {Number} limit
+     */
+    async getTopCitiesByRegion(regionId, limit) {
+        check.assert.assigned(regionId, 'regionId is required');
+        check.assert.assigned(limit, 'limit is required');
+        const lower = KeysUtility.makeKey128(regionId, 0);
+        const upper = KeysUtility.makeKey128(regionId, (1n << 64n) - 1n);
+        const result = await this.bc.getTableRowsByIndex(this.contractAccount, 'cities', 'default', 4, 'i128', lower, upper, limit);
+        return result.rows;
+    }
+
     async getPlaces() {
         return await this.tables.getTable('places');
     }
@@ -162,6 +216,53 @@ class CatalogsUtility {
             return data.rows[0].name;
         return undefined;
     }
+
+    /**
+     * Languages of entity translations.
+     * @param {String} table translations table ('cattrans', 'ctr', 'cttr', 'pltr', 'rtr')
+     * @param {Number} id entity id
+     */
+    async getTranslationLangs(table, id) {
+        check.assert.assigned(table, 'table is required');
+        check.assert.assigned(id, 'id is required');
+        let data = await this.bc.getTableRows(this.contractAccount, 'translangs', table, id);
+        if (data && data.rows.length == 1)
+            return data.rows[0].langs;
+        return [];
+    }
+
+    /**
+     * Last catalogs revision and first revision kept by journal.
+     * @returns {Object} { revision, compacted_before }
+     */
+    async getRevision() {
+        let data = await this.bc.getTableRows(this.contractAccount, 'catrevision', 'default');
+        if (data && data.rows.length == 1)
+            return data.rows[0];
+        return { revision: 0, compacted_before: 1 };
+    }
+
+    /**
+     * Catalogs changes made after specified revision.
+     * Replica older than 'compacted_before' must be reloaded instead ('complete' is false).
+     * @param {Number} sinceRevision last revision applied by replica
+     * @returns {Object} { revision, complete, changes: [{ revision, kind, entity_id, lang, op }] }
+     */
+    async getChanges(sinceRevision) {
+        check.assert.assigned(sinceRevision, 'sinceRevision is required');
+        const state = await this.getRevision();
+        const from = Number(sinceRevision) + 1;
+        let changes = [];
+        if (from <= state.revision) {
+            const result = await this.bc.getTableRowsByIndex(this.contractAccount, 'catjournal', 'default', 1, 'i64', from, state.revision);
+            changes = result.rows;
+        }
+        return {
+            revision: state.revision,
+            complete: from >= state.compacted_before,
+            changes: changes
+        };
+    }
 };
 
 module.exports = CatalogsUtility;
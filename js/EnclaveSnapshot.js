@@ -0,0 +1,45 @@
+const check = require('check-types');
+
+/**
+ * In-memory enclave permissions matrix returned by 'encsnapshot'.
+ */
+class EnclaveSnapshot {
+
+    /**
+     * @param {Object} snapshot 'encsnapshot' result
+     */
+    constructor(snapshot) {
+        check.assert.object(snapshot, 'snapshot is required');
+        this.time = Number(snapshot.time);
+        this.validUntil = Number(snapshot.valid_until);
+        this.scripts = new Map(snapshot.scripts.map((id, i) => [String(id), i]));
+        this.grantees = new Map(snapshot.grantees.map((name, i) => [name, i]));
+        this.known = Buffer.from(snapshot.known, 'hex');
+        this.granted = Buffer.from(snapshot.granted, 'hex');
+    }
+
+    static testBit(bits, bit) {
+        return (bits[bit >> 3] & (1 << (bit & 7))) !== 0;
+    }
+
+    /**
+     * Permission of grantee to run script within enclave.
+     * @param {Number} scriptId
+     * @param {EosioName} grantee
+     * @returns {Boolean|undefined} undefined if there is no permission
+     */
+    isGranted(scriptId, grantee) {
+        const s = this.scripts.get(String(scriptId));
+        const g = this.grantees.get(grantee);
+        if (typeof s == 'undefined' || typeof g == 'undefined') {
+            return undefined;
+        }
+        const bit = s * this.grantees.size + g;
+        if (!EnclaveSnapshot.testBit(this.known, bit)) {
+            return undefined;
+        }
+        return EnclaveSnapshot.testBit(this.granted, bit);
+    }
+};
+
+module.exports = EnclaveSnapshot;
@@ -0,0 +1,114 @@
+const crypto = require('crypto');
+const check = require('check-types');
+
+/**
+ * Contract composite keys helpers.
+ * Mirrors 'common/Keys.hpp' of contracts.
+ */
+class KeysUtility {
+
+    static charToValue(c) {
+        if (c === '.') {
+            return 0n;
+        }
+        if (c >= '1' && c <= '5') {
+            return BigInt(c.charCodeAt(0) - '1'.charCodeAt(0) + 1);
+        }
+        if (c >= 'a' && c <= 'z') {
+            return BigInt(c.charCodeAt(0) - 'a'.charCodeAt(0) + 6);
+        }
+        throw new Error('character is not in allowed character set for names');
+    }
+
+    /**
+     * Convert EOSIO name to its 64-bit value.
+     * @param {EosioName} name
+     * @returns {BigInt}
+     */
+    static nameToBigInt(name) {
+        check.assert.string(name, 'name must be string');
+        check.assert.lessOrEqual(name.length, 13, 'string is too long to be a valid name');
+        let value = 0n;
+        const n = Math.min(name.length, 12);
+        for (let i = 0; i < n; ++i) {
+            value = (value << 5n) | KeysUtility.charToValue(name[i]);
+        }
+        value <<= BigInt(4 + 5 * (12 - n));
+        if (name.length === 13) {
+            const v = KeysUtility.charToValue(name[12]);
+            check.assert.lessOrEqual(Number(v), 0x0f, 'thirteenth character in name cannot be a letter that comes after j');
+            value |= v;
+        }
+        return value;
+    }
+
+    /**
+     * Make 128-bit key from two 64-bit parts.
+     * @param {BigInt|Number|String} high
+     * @param {BigInt|Number|String} low
+     * @returns {String}
+     */
+    static makeKey128(high, low) {
+        return ((BigInt(high) << 64n) | BigInt(low)).toString();
+    }
+
+    /**
+     * Make 256-bit key from up to four 64-bit words.
+     * @param {...(BigInt|Number|String)} words
+     * @returns {String} hex string accepted by 'get_table_rows' for 'sha256' indexes
+     */
+    static makeKey256(...words) {
+        check.assert.lessOrEqual(words.length, 4, 'too many words for 256-bit key');
+        while (words.length < 4) {
+            words.push(0n);
+        }
+        return words.map(w => BigInt.asUintN(64, BigInt(w)).toString(16).padStart(16, '0')).join('');
+    }
+
+    /**
+     * SHA256 of two concatenated 256-bit keys.
+     * @param {String} a hex
+     * @param {String} b hex
+     * @returns {String} hex
+     */
+    static hashKeys(a, b) {
+        return crypto.createHash('sha256').update(Buffer.from(a + b, 'hex')).digest('hex');
+    }
+
+    /**
+     * Service kind: first 128 bits of hash of (type, protocol).
+     * @param {String} type
+     * @param {String} protocol
+     * @returns {String} hex
+     */
+    static makeServiceKind(type, protocol) {
+        const t = crypto.createHash('sha256').update(type).digest('hex');
+        const p = crypto.createHash('sha256').update(protocol).digest('hex');
+        return KeysUtility.hashKeys(t, p).slice(0, 32);
+    }
+
+    /**
+     * Unsigned 32-bit word ordered as signed date, mirrors common::Keys::ordered.
+     * @param {Number|BigInt} value
+     * @returns {BigInt}
+     */
+    static orderedInt32(value) {
+        return BigInt.asUintN(32, BigInt(value)) ^ 0x80000000n;
+    }
+
+    /**
+     * Requests log content key.
+     * @param {EosioName} sender
+     * @param {EosioName} receiver
+     * @param {Number} date
+     * @param {String} request
+     * @returns {String} hex
+     */
+    static makeRequestKey(sender, receiver, date, request) {
+        const header = KeysUtility.makeKey256(KeysUtility.nameToBigInt(sender), KeysUtility.nameToBigInt(receiver), BigInt.asUintN(32, BigInt(date)));
+        const body = crypto.createHash('sha256').update(request).digest('hex');
+        return KeysUtility.hashKeys(header, body);
+    }
+};
+
+module.exports = KeysUtility;
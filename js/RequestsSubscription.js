@@ -0,0 +1,185 @@
+const check = require('check-types');
+const WebSocket = require('ws');
+const { TextEncoder, TextDecoder } = require('util');
+const Serialize = require('eosjs/dist/eosjs-serialize');
+const AggregionBlockchain = require('./AggregionBlockchain.js');
+
+// Serializer returns 'bytes' as hex string.
+const toBytes = (value) => typeof value === 'string' ? Serialize.hexToUint8Array(value) : value;
+
+/**
+ * Delivers 'reqnotify' notifications of receiver account.
+ * Reads action traces pushed by 'state_history_plugin' websocket ('--trace-history' enabled).
+ * Notifications are delivered at least once: after reconnect block which wasn't completely
+ * delivered is streamed again, forked out blocks are delivered unless 'irreversibleOnly' is set.
+ */
+class RequestsSubscription {
+
+    /**
+     * @param {String} contractAccount
+     * @param {AggregionBlockchain} blockchain
+     * @param {EosioName} receiver
+     * @param {Function} callback called with request descriptor {id, sender, receiver, date, request_hash}
+     * @param {String} stateHistoryUrl e.g. 'ws://127.0.0.1:8080'
+     * @param {Function} onError called with stream or callback error, stream is reconnected with backoff
+     */
+    constructor(contractAccount, blockchain, receiver, callback, stateHistoryUrl, onError = null) {
+        check.assert.function(callback, 'callback must be function');
+        check.assert.nonEmptyString(stateHistoryUrl, 'state history url must be specified');
+        check.assert.maybe.function(onError, 'onError must be function');
+        this.contractAccount = contractAccount;
+        this.bc = blockchain;
+        this.receiver = receiver;
+        this.callback = callback;
+        this.url = stateHistoryUrl;
+        this.onError = onError;
+        this.interval = 500;
+        this.maxBackoff = 64;
+        this.messagesInFlight = 10;
+        this.nextBlock = 0;
+        this.failures = 0;
+        this.irreversibleOnly = false;
+        this.socket = null;
+        this.timer = null;
+        this.waiters = [];
+    }
+
+    /**
+     * Start delivery of notifications.
+     * @param {Number} fromBlock first block to read, next to head block by default
+     * @param {Boolean} irreversibleOnly deliver notifications of irreversible blocks only
+     */
+    async start(fromBlock = null, irreversibleOnly = false) {
+        if (fromBlock === null) {
+            const info = await this.bc.rpc.get_info();
+            fromBlock = info.head_block_num + 1;
+        }
+        this.nextBlock = fromBlock;
+        this.irreversibleOnly = irreversibleOnly;
+        this.actionTypes = (await this.bc.api.getContract(this.contractAccount)).actions;
+        this.active = true;
+        this.connect();
+    }
+
+    stop() {
+        this.active = false;
+        clearTimeout(this.timer);
+        this.timer = null;
+        if (this.socket !== null) {
+            this.socket.terminate();
+            this.socket = null;
+        }
+    }
+
+    /**
+     * Resolves when notifications of blocks up to 'blockNum' are delivered.
+     * @param {Number} blockNum
+     */
+    waitBlock(blockNum) {
+        if (blockNum < this.nextBlock) {
+            return Promise.resolve();
+        }
+        return new Promise(resolve => this.waiters.push({ blockNum, resolve }));
+    }
+
+    connect() {
+        const socket = new WebSocket(this.url, { perMessageDeflate: false });
+        let types = null;
+        // Messages are handled in order, next one waits for callbacks of previous block.
+        let handled = Promise.resolve();
+        socket.on('message', (data) => {
+            handled = handled.then(async () => {
+                if (this.socket !== socket) {
+                    return;
+                }
+                if (types === null) {
+                    types = Serialize.getTypesFromAbi(Serialize.createInitialTypes(), JSON.parse(data.toString()));
+                    socket.send(this.serialize(types, 'request', ['get_blocks_request_v0', {
+                        start_block_num: this.nextBlock,
+                        end_block_num: 0xffffffff,
+                        max_messages_in_flight: this.messagesInFlight,
+                        have_positions: [],
+                        irreversible_only: this.irreversibleOnly,
+                        fetch_block: false,
+                        fetch_traces: true,
+                        fetch_deltas: false,
+                    }]));
+                    return;
+                }
+                const [, result] = this.deserialize(types, 'result', new Uint8Array(data));
+                if (result.this_block) {
+                    await this.deliverBlock(types, result);
+                }
+                socket.send(this.serialize(types, 'request', ['get_blocks_ack_request_v0', { num_messages: 1 }]));
+            }).catch(exc => {
+                this.report(exc);
+                socket.terminate();
+            });
+        });
+        socket.on('error', exc => this.report(exc));
+        socket.on('close', () => {
+            if (this.socket !== socket) {
+                return;
+            }
+            this.socket = null;
+            if (this.active) {
+                // Node may be temporarily unavailable, resume from the first undelivered block.
+                this.failures++;
+                const backoff = Math.min(2 ** this.failures, this.maxBackoff);
+                this.timer = setTimeout(() => this.connect(), this.interval * backoff);
+            }
+        });
+        this.socket = socket;
+    }
+
+    async deliverBlock(types, result) {
+        const blockNum = result.this_block.block_num;
+        if (result.traces) {
+            const traces = this.deserialize(types, 'transaction_trace[]', toBytes(result.traces));
+            for (const [, trace] of traces) {
+                // Only executed transactions change state (0 - executed).
+                if (trace.status !== 0) {
+                    continue;
+                }
+                for (const [, action] of trace.action_traces) {
+                    if (action.receiver === this.receiver && action.act.account === this.contractAccount && action.act.name === 'reqnotify') {
+                        const type = this.actionTypes.get('reqnotify');
+                        await this.callback(this.deserialize(new Map(), type, toBytes(action.act.data)));
+                    }
+                }
+            }
+        }
+        this.nextBlock = blockNum + 1;
+        this.failures = 0;
+        this.waiters = this.waiters.filter(w => {
+            if (w.blockNum < this.nextBlock) {
+                w.resolve();
+                return false;
+            }
+            return true;
+        });
+    }
+
+    report(exc) {
+        if (this.onError) {
+            try {
+                this.onError(exc);
+            } catch (ignored) {
+            }
+        }
+    }
+
+    serialize(types, type, value) {
+        const buffer = new Serialize.SerialBuffer({ textEncoder: new TextEncoder(), textDecoder: new TextDecoder() });
+        Serialize.getType(types, type).serialize(buffer, value);
+        return buffer.asUint8Array();
+    }
+
+    deserialize(types, type, array) {
+        const buffer = new Serialize.SerialBuffer({ textEncoder: new TextEncoder(), textDecoder: new TextDecoder(), array });
+        const serializer = typeof type === 'string' ? Serialize.getType(types, type) : type;
+        return serializer.deserialize(buffer);
+    }
+};
+
+module.exports = RequestsSubscription;
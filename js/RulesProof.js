@@ -0,0 +1,93 @@
+const check = require('check-types');
+const KeysUtility = require('./KeysUtility.js');
+
+const ZeroHash = '0'.repeat(64);
+
+/**
+ * Offline verification of access rules proofs returned by 'sarproof'.
+ * Mirrors 'aggregion/RulesCommitment.cpp' of contracts.
+ */
+class RulesProof {
+
+    /**
+     * Rule kinds, see 'RuleKind' of contracts.
+     */
+    static get Kind() {
+        return {
+            Trust: 0,
+            Approve: 1,
+            Grant: 2,
+            EnclaveAccess: 3,
+        };
+    }
+
+    /**
+     * Rule key.
+     * @param {Number} kind
+     * @param {...(BigInt|Number|String)} words rule identity, names as BigInt
+     * @returns {String} hex
+     */
+    static makeRuleKey(kind, ...words) {
+        return KeysUtility.makeKey256(kind, ...words);
+    }
+
+    static makeTrustKey(truster, trustee) {
+        return RulesProof.makeRuleKey(RulesProof.Kind.Trust, KeysUtility.nameToBigInt(truster), KeysUtility.nameToBigInt(trustee), 0);
+    }
+
+    static makeApproveKey(approver, scriptId) {
+        return RulesProof.makeRuleKey(RulesProof.Kind.Approve, KeysUtility.nameToBigInt(approver), scriptId, 0);
+    }
+
+    static makeGrantKey(grantee, scriptId) {
+        return RulesProof.makeRuleKey(RulesProof.Kind.Grant, KeysUtility.nameToBigInt(grantee), scriptId, 0);
+    }
+
+    static makeEnclaveAccessKey(enclaveOwner, scriptId, grantee) {
+        return RulesProof.makeRuleKey(RulesProof.Kind.EnclaveAccess, KeysUtility.nameToBigInt(enclaveOwner), scriptId, KeysUtility.nameToBigInt(grantee));
+    }
+
+    static hashLeaf(ruleKey, value, expiresAt) {
+        return KeysUtility.hashKeys(ruleKey, KeysUtility.makeKey256(value ? 1 : 0, expiresAt, 0));
+    }
+
+    static hashNode(left, right) {
+        if (left === ZeroHash && right === ZeroHash) {
+            return ZeroHash;
+        }
+        return KeysUtility.hashKeys(left, right);
+    }
+
+    /**
+     * Root computed from rule inclusion proof.
+     * @param {String} ruleKey
+     * @param {Object} proof
+     * @returns {String} hex
+     */
+    static computeRoot(ruleKey, proof) {
+        check.assert.array(proof.siblings, 'siblings are required');
+        let hash = RulesProof.hashLeaf(ruleKey, proof.value, proof.expires_at);
+        let index = BigInt(proof.index);
+        for (const sibling of proof.siblings) {
+            hash = (index & 1n) ? RulesProof.hashNode(sibling, hash) : RulesProof.hashNode(hash, sibling);
+            index >>= 1n;
+        }
+        return hash;
+    }
+
+    /**
+     * Check that rule with proof value is committed to root.
+     * @param {String} root
+     * @param {String} ruleKey
+     * @param {Object} proof
+     * @returns {Boolean}
+     */
+    static verify(root, ruleKey, proof) {
+        if (!proof.found) {
+            return false;
+        }
+        return RulesProof.computeRoot(ruleKey, proof) === root;
+    }
+};
+
+module.exports = RulesProof;
@@ -7,6 +7,10 @@ const DmpusersUtility = require('./DmpusersUtility');
 const CatalogsContract = require('./CatalogsContract');
 const CatalogsUtility = require('./CatalogsUtility');
 const TablesUtility = require('./TablesUtility');
+const KeysUtility = require('./KeysUtility');
+const RequestsSubscription = require('./RequestsSubscription');
+const RulesProof = require('./RulesProof');
+const EnclaveSnapshot = require('./EnclaveSnapshot');
 
 module.exports = {
     AggregionBlockchain,
@@ -17,5 +21,9 @@ module.exports = {
     DmpusersUtility,
     CatalogsContract,
     CatalogsUtility,
-    TablesUtility
+    TablesUtility,
+    KeysUtility,
+    RequestsSubscription,
+    RulesProof,
+    EnclaveSnapshot
 }
@@ -3,12 +3,15 @@ const AggregionBlockchain = require('../js/AggregionBlockchain.js');
 const AggregionNode = require('../js/AggregionNode.js');
 const AggregionContract = require('../js/AggregionContract.js');
 const AggregionUtility = require('../js/AggregionUtility.js');
+const KeysUtility = require('../js/KeysUtility.js');
+const RequestsSubscription = require('../js/RequestsSubscription.js');
 const TestConfig = require('./TestConfig.js');
 const tools = require('./TestTools.js');
 
 const chai = require('chai')
 const chaiAsPromised = require('chai-as-promised');
 const check = require('check-types');
+const crypto = require('crypto');
 chai.use(chaiAsPromised);
 var assert = chai.assert;
 var should = chai.should();
@@ -18,7 +21,7 @@ describe('Aggregion', function () {
     const config = new TestConfig(__dirname + '/config.json')
     const contractConfig = config.contracts.aggregion;
 
-    let node = new AggregionNode(config.getSignatureProvider(), config.node.executable, config.node.endpoint, config.node.workdir);
+    let node = new AggregionNode(config.getSignatureProvider(), config.node.executable, config.node.endpoint, config.node.workdir, config.node.state_history_endpoint);
     let bc = new AggregionBlockchain(config.getNodeUrl(), [config.blockchain.eosio_root_key.private], config.debug);
     let contract = new AggregionContract(contractConfig.account, bc);
     let util = new AggregionUtility(contractConfig.account, bc);
@@ -28,14 +31,18 @@ describe('Aggregion', function () {
 
     beforeEach(async function () {
         await node.start();
+        await tools.activateFeatures(bc, config);
         aggregion = await tools.makeAccount(bc, contractConfig.account);
         await bc.deploy(aggregion.account, contractConfig.wasm, contractConfig.abi, aggregion.permission);
+        await bc.addCodePermission(aggregion.account, 'notify', 'reqnotify', aggregion.permission);
     });
 
     afterEach(async function () {
         await node.stop();
     });
 
+    const toName = (i) => [...i.toString(5)].map(d => String.fromCharCode(97 + Number(d))).join('');
+
     describe('#providers', function () {
         it('should not register provider with invalid name', async () => {
             const alice = await tools.makeAccount(bc, 'ALiCE');
@@ -74,7 +81,144 @@ describe('Aggregion', function () {
                 await contract.unregprov(alice.account, alice.permission);
                 (await util.isProviderExists(alice.account))
                     .should.be.false;
+                (await util.isProviderRemoving(alice.account))
+                    .should.be.false;
+            }
+        });
+        it('should not cleanup provider which is not being unregistered', async () => {
+            const alice = await tools.makeAccount(bc, 'alice');
+            await contract.regprov(alice.account, 'Alice provider', alice.permission);
+            await contract.cleanup(alice.account, 10, alice.permission)
+                .should.be.rejectedWith('404. Provider is not being unregistered!');
+        });
+        it('should not cleanup with zero rows limit', async () => {
+            const alice = await tools.makeAccount(bc, 'alice');
+            await contract.regprov(alice.account, 'Alice provider', alice.permission);
+            await contract.cleanup(alice.account, 0, alice.permission)
+                .should.be.rejectedWith('403. Rows limit must be positive!');
+        });
+        it('should remove provider with dependent records', async () => {
+            const alice = await tools.makeAccount(bc, 'alice');
+            await contract.regprov(alice.account, 'Alice provider', alice.permission);
+            for (let i = 1; i <= 5; ++i) {
+                await contract.addsvc(alice.account, 'svc' + i, 'Service', 'http', 'local', 'http://alice.ru/', alice.permission);
+            }
+            await contract.unregprov(alice.account, alice.permission);
+            (await util.isProviderExists(alice.account))
+                .should.be.false;
+            (await util.isProviderRemoving(alice.account))
+                .should.be.false;
+        });
+        it('should unregister provider with more dependent records than one batch', async () => {
+            const alice = await tools.makeAccount(bc, 'alice');
+            await contract.regprov(alice.account, 'Alice provider', alice.permission);
+            for (let i = 0; i < 105; ++i) {
+                await contract.addsvc(alice.account, 'svc' + toName(i), 'Service', 'http', 'local', 'http://alice.ru/', alice.permission);
+            }
+            await contract.unregprov(alice.account, alice.permission);
+            (await util.isProviderExists(alice.account))
+                .should.be.true;
+            (await util.isProviderRemoving(alice.account))
+                .should.be.true;
+            await contract.updprov(alice.account, 'New description', alice.permission)
+                .should.be.rejectedWith('403. Provider is being unregistered!');
+            await contract.addsvc(alice.account, 'svcnew', 'Service', 'http', 'local', 'http://alice.ru/', alice.permission)
+                .should.be.rejectedWith('404. Unknown provider!');
+            await contract.unregprov(alice.account, alice.permission)
+                .should.be.rejectedWith('403. Provider is already being unregistered!');
+
+            await contract.cleanup(alice.account, 3, alice.permission);
+            (await util.isProviderRemoving(alice.account))
+                .should.be.true;
+            await contract.cleanup(alice.account, 100, alice.permission);
+            (await util.isProviderExists(alice.account))
+                .should.be.false;
+            (await util.isProviderRemoving(alice.account))
+                .should.be.false;
+            assert.isUndefined(await util.getService(alice.account, 'svc' + toName(104)));
+        });
+        it('should count provider services, scripts, trusts, approves and grants', async () => {
+            const alice = await tools.makeAccount(bc, 'alice');
+            const bob = await tools.makeAccount(bc, 'bob');
+            const hash = 'ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad';
+            await contract.regprov(alice.account, 'Alice provider', alice.permission);
+            await contract.regprov(bob.account, 'Bob provider', bob.permission);
+            await contract.addsvc(alice.account, 'svc1', 'Service One', 'http', 'local', 'http://alice.ru/', alice.permission);
+            await contract.addsvc(alice.account, 'svc2', 'Service Two', 'http', 'local', 'http://alice.ru/', alice.permission);
+            await contract.addscript(bob.account, 'script1', 'v1', 'Newton function', hash, 'http://example.com', bob.permission);
+            await contract.trust(alice.account, bob.account, alice.permission);
+            await contract.trust(alice.account, bob.account, alice.permission);
+            await contract.execapprove(alice.account, hash, alice.permission);
+            await contract.grantaccess(bob.account, hash, alice.account, bob.permission);
+            {
+                const stats = await contract.getprovstats(alice.account, alice.permission);
+                assert.deepEqual([2, 0, 1, 1, 1], [stats.services, stats.scripts, stats.trusts, stats.approves, stats.grants].map(Number));
+                const bobStats = await util.getProviderStats(bob.account);
+                assert.equal(1, Number(bobStats.scripts));
             }
+            await contract.remsvc(alice.account, 'svc1', alice.permission);
+            await contract.untrust(alice.account, bob.account, alice.permission);
+            await contract.denyaccess(bob.account, hash, alice.account, bob.permission);
+            {
+                const stats = await contract.getprovstats(alice.account, alice.permission);
+                assert.deepEqual([1, 0, 0, 1, 0], [stats.services, stats.scripts, stats.trusts, stats.approves, stats.grants].map(Number));
+            }
+            await contract.unregprov(alice.account, alice.permission);
+            assert.isUndefined(await util.getProviderStats(alice.account));
+        });
+        it('should recount provider counters one row per call', async function () {
+            const alice = await tools.makeAccount(bc, 'alice');
+            const bob = await tools.makeAccount(bc, 'bob');
+            const hash = 'ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad';
+            await tools.upgradeFromBaseline(this, bc, config, aggregion, async () => {
+                await contract.regprov(alice.account, 'Alice provider', alice.permission);
+                await contract.regprov(bob.account, 'Bob provider', bob.permission);
+                await contract.addsvc(alice.account, 'svc1', 'Service One', 'http', 'local', 'http://alice.ru/', alice.permission);
+                await contract.addsvc(alice.account, 'svc2', 'Service Two', 'http', 'local', 'http://alice.ru/', alice.permission);
+                await contract.addscript(bob.account, 'script1', 'v1', 'Newton function', hash, 'http://example.com', bob.permission);
+                await contract.addscript(bob.account, 'script1', 'v2', 'Newton function', hash.replace('ba', 'ab'), 'http://example.com', bob.permission);
+                await contract.trust(alice.account, bob.account, alice.permission);
+                await contract.execapprove(alice.account, hash, alice.permission);
+                await contract.grantaccess(bob.account, hash, alice.account, bob.permission);
+            });
+            assert.isUndefined(await util.getProviderStats(alice.account));
+
+            await contract.migrate('scripts', 10, aggregion.permission);
+            let calls = 0;
+            for (; calls < 20; ++calls) {
+                const done = await contract.migrate('provstats', 1, aggregion.permission)
+                    .then(() => false, () => true);
+                if (done)
+                    break;
+            }
+            assert.isAbove(calls, 2);
+            assert.isBelow(calls, 20);
+            const stats = await contract.getprovstats(alice.account, alice.permission);
+            assert.deepEqual([2, 0, 1, 1, 1], [stats.services, stats.scripts, stats.trusts, stats.approves, stats.grants].map(Number));
+            const bobStats = await util.getProviderStats(bob.account);
+            assert.equal(2, Number(bobStats.scripts));
+        });
+        it('should count changes once while provider counters are recounted', async function () {
+            const alice = await tools.makeAccount(bc, 'alice');
+            await tools.upgradeFromBaseline(this, bc, config, aggregion, async () => {
+                await contract.regprov(alice.account, 'Alice provider', alice.permission);
+                await contract.addsvc(alice.account, 'svc1', 'Service One', 'http', 'local', 'http://alice.ru/', alice.permission);
+                await contract.addsvc(alice.account, 'svc2', 'Service Two', 'http', 'local', 'http://alice.ru/', alice.permission);
+            });
+            await contract.migrate('scripts', 10, aggregion.permission);
+
+            // Recount stops after 'svc1': change of visited row is applied, row not visited yet is counted by recount.
+            await contract.migrate('provstats', 1, aggregion.permission);
+            await contract.remsvc(alice.account, 'svc1', alice.permission);
+            await contract.addsvc(alice.account, 'svc3', 'Service Three', 'http', 'local', 'http://alice.ru/', alice.permission);
+            for (let calls = 0; calls < 20; ++calls) {
+                const done = await contract.migrate('provstats', 1, aggregion.permission)
+                    .then(() => false, () => true);
+                if (done)
+                    break;
+            }
+            const stats = await contract.getprovstats(alice.account, alice.permission);
+            assert.equal(2, Number(stats.services));
         });
     });
 
@@ -147,6 +291,53 @@ describe('Aggregion', function () {
             let svc = await util.getService(alice.account, 'svc1');
             assert.isUndefined(svc);
         });
+        it('should discover services of all providers by type and protocol', async () => {
+            const alice = await tools.makeAccount(bc, 'alice');
+            const bob = await tools.makeAccount(bc, 'bob');
+            await contract.regprov(alice.account, 'Alice provider', alice.permission);
+            await contract.regprov(bob.account, 'Bob provider', bob.permission);
+            await contract.addsvc(alice.account, 'svc1', 'Alice analytics', 'grpc', 'analytics', 'http://alice.ru/', alice.permission);
+            await contract.addsvc(alice.account, 'svc2', 'Alice storage', 'grpc', 'storage', 'http://alice.ru/', alice.permission);
+            await contract.addsvc(bob.account, 'svc1', 'Bob analytics', 'http', 'analytics', 'http://bob.ru/', bob.permission);
+            await contract.addsvc(bob.account, 'svc2', 'Bob analytics', 'grpc', 'analytics', 'http://bob.ru/', bob.permission);
+
+            let found = await util.findServices('analytics', 'grpc');
+            assert.deepEqual([[alice.account, 'svc1'], [bob.account, 'svc2']], found.map(s => [s.scope, s.service]));
+
+            await contract.updsvc(bob.account, 'svc1', 'Bob analytics', 'grpc', 'analytics', 'http://bob.ru/', bob.permission);
+            await contract.remsvc(alice.account, 'svc1', alice.permission);
+            found = await util.findServices('analytics', 'grpc');
+            assert.deepEqual([[bob.account, 'svc1'], [bob.account, 'svc2']], found.map(s => [s.scope, s.service]));
+            assert.deepEqual(await util.getService(bob.account, 'svc1'), found[0]);
+
+            await contract.unregprov(bob.account, bob.permission);
+            assert.equal(0, (await util.findServices('analytics', 'grpc')).length);
+            assert.equal(1, (await util.findServices('storage', 'grpc')).length);
+        });
+        it('should migrate discovery by services, not by providers', async function () {
+            const alice = await tools.makeAccount(bc, 'alice');
+            const bob = await tools.makeAccount(bc, 'bob');
+            await tools.upgradeFromBaseline(this, bc, config, aggregion, async () => {
+                await contract.regprov(alice.account, 'Alice provider', alice.permission);
+                await contract.regprov(bob.account, 'Bob provider', bob.permission);
+                for (const svc of ['svc1', 'svc2', 'svc3']) {
+                    await contract.addsvc(alice.account, svc, 'Alice analytics', 'grpc', 'analytics', 'http://alice.ru/', alice.permission);
+                }
+                await contract.addsvc(bob.account, 'svc1', 'Bob analytics', 'grpc', 'analytics', 'http://bob.ru/', bob.permission);
+            });
+            assert.equal(0, (await util.findServices('analytics', 'grpc')).length);
+
+            // Each provider is counted as a row too: [svc1, svc2], [svc3, alice], [svc1, bob], [].
+            for (let i = 0; i < 4; ++i) {
+                await contract.migrate('services', 2, aggregion.permission);
+            }
+            await contract.migrate('services', 2, aggregion.permission)
+                .should.be.rejectedWith('403. Table is already migrated!');
+            const found = await util.findServices('analytics', 'grpc');
+            assert.deepEqual([[alice.account, 'svc1'], [alice.account, 'svc2'], [alice.account, 'svc3'], [bob.account, 'svc1']],
+                found.map(s => [s.scope, s.service]).sort());
+            assert.equal('http://bob.ru/', found.find(s => s.scope === bob.account).info.endpoint);
+        });
     });
 
     describe('#requestslog', function () {
@@ -191,6 +382,171 @@ describe('Aggregion', function () {
             await contract.sendreq(alice.account, jimbo.account, 82034, "my request 1", alice.permission)
                 .should.be.rejected;
         });
+        it('should not write duplicates after keys migration', async function () {
+            const alice = await tools.makeAccount(bc, 'alice');
+            const jimbo = await tools.makeAccount(bc, 'jimbo');
+            const hash = crypto.createHash('sha256').update("my request 1").digest('hex');
+            await tools.upgradeFromBaseline(this, bc, config, aggregion, async () => {
+                await contract.sendreq(alice.account, jimbo.account, 82034, "my request 1", alice.permission);
+            });
+            assert.isUndefined(await util.getRequestPayload(hash));
+            await contract.migrate('reqslog', 10, aggregion.permission);
+            assert.equal(1, Number((await util.getRequestPayload(hash)).refs));
+            assert.deepEqual(["my request 1"], (await util.getRequestsLog()).map(r => r.request));
+            await contract.sendreq(alice.account, jimbo.account, 82034, "my request 1", alice.permission)
+                .should.be.rejected;
+            await contract.sendreq(alice.account, jimbo.account, 82035, "my request 1", alice.permission);
+        });
+        it('should select requests by receiver and sender date range', async () => {
+            const alice = await tools.makeAccount(bc, 'alice');
+            const jimbo = await tools.makeAccount(bc, 'jimbo');
+            const kate = await tools.makeAccount(bc, 'kate');
+            await contract.sendreq(alice.account, jimbo.account, 82036, "my request 3", alice.permission);
+            await contract.sendreq(alice.account, jimbo.account, 82034, "my request 1", alice.permission);
+            await contract.sendreq(kate.account, jimbo.account, 82035, "my request 2", kate.permission);
+            await contract.sendreq(alice.account, kate.account, 82035, "my request 2", alice.permission);
+            await contract.sendreq(jimbo.account, alice.account, 82035, "my request 2", jimbo.permission);
+
+            const inbound = await util.getRequestsByReceiver(jimbo.account, 82035, 82040);
+            assert.deepEqual([82035, 82036], inbound.map(r => Number(r.date)));
+            assert.deepEqual([kate.account, alice.account], inbound.map(r => r.sender));
+
+            const outbound = await util.getRequestsBySender(alice.account, 0, 82035);
+            assert.deepEqual([jimbo.account, kate.account], outbound.map(r => r.receiver));
+        });
+        it('should notify receiver about new requests', async () => {
+            const alice = await tools.makeAccount(bc, 'alice');
+            const jimbo = await tools.makeAccount(bc, 'jimbo');
+            const kate = await tools.makeAccount(bc, 'kate');
+            let received = [];
+            const subscription = new RequestsSubscription(aggregion.account, bc, jimbo.account, r => received.push(r), config.getStateHistoryUrl());
+            await subscription.start();
+            try {
+                await contract.sendreq(alice.account, jimbo.account, 82034, "my request 1", alice.permission);
+                await contract.sendreq(alice.account, kate.account, 82034, "my request 2", alice.permission);
+                await contract.sendreq(kate.account, jimbo.account, 82035, "my request 3", kate.permission);
+                await subscription.waitBlock((await bc.rpc.get_info()).head_block_num);
+            } finally {
+                subscription.stop();
+            }
+            assert.deepEqual([alice.account, kate.account], received.map(r => r.sender));
+            assert.deepEqual([82034, 82035], received.map(r => Number(r.date)));
+            assert.equal(crypto.createHash('sha256').update("my request 3").digest('hex'), received[1].request_hash);
+        });
+        it('should notify receiver without code permission on active', async () => {
+            const alice = await tools.makeAccount(bc, 'alice');
+            await contract.sendreq(alice.account, alice.account, 82034, "my request 1", alice.permission);
+            const account = await bc.rpc.get_account(aggregion.account);
+            const active = account.permissions.find(p => p.perm_name == 'active');
+            assert.deepEqual([], active.required_auth.accounts);
+        });
+        it('should accept requests to receiver without account', async () => {
+            const alice = await tools.makeAccount(bc, 'alice');
+            await contract.sendreq(alice.account, 'nobody', 82034, "my request", alice.permission);
+            const outbound = await util.getRequestsBySender(alice.account, 0, 82035);
+            assert.deepEqual(['nobody'], outbound.map(r => r.receiver));
+        });
+        it('should count requests per receiver per day', async () => {
+            const alice = await tools.makeAccount(bc, 'alice');
+            const jimbo = await tools.makeAccount(bc, 'jimbo');
+            const kate = await tools.makeAccount(bc, 'kate');
+            const day = 86400;
+            await contract.sendreq(alice.account, jimbo.account, day + 1, "12345", alice.permission);
+            await contract.sendreq(alice.account, jimbo.account, day + 2, "123", alice.permission);
+            await contract.sendreq(alice.account, kate.account, day + 3, "1", alice.permission);
+            await contract.sendreq(alice.account, jimbo.account, 3 * day, "12", alice.permission);
+            await contract.sendreq(kate.account, jimbo.account, day, "1", kate.permission);
+
+            const stats = await contract.getreqstats(alice.account, 1, 2, alice.permission);
+            assert.deepEqual([jimbo.account, kate.account], stats.map(s => s.receiver));
+            assert.deepEqual([2, 1], stats.map(s => Number(s.count)));
+            assert.deepEqual([8, 1], stats.map(s => Number(s.bytes)));
+
+            const rows = await util.getRequestsStats(alice.account, 0, 10);
+            assert.deepEqual([1, 1, 3], rows.map(s => Number(s.day)));
+
+            await contract.sendreq(alice.account, jimbo.account, -1, "1", alice.permission);
+            await contract.sendreq(alice.account, jimbo.account, -day, "1", alice.permission);
+            await contract.sendreq(alice.account, jimbo.account, -day - 1, "1", alice.permission);
+            const before = await util.getRequestsStats(alice.account, -10, 0);
+            assert.deepEqual([-2, -1], before.map(s => Number(s.day)));
+            assert.deepEqual([1, 2], before.map(s => Number(s.count)));
+        });
+        it('should store same request payload once', async () => {
+            const alice = await tools.makeAccount(bc, 'alice');
+            const jimbo = await tools.makeAccount(bc, 'jimbo');
+            const kate = await tools.makeAccount(bc, 'kate');
+            const body = 'select * from audience where segment = 42';
+            const hash = crypto.createHash('sha256').update(body).digest('hex');
+            await contract.sendreq(alice.account, jimbo.account, 100, body, alice.permission);
+            await contract.sendreq(alice.account, kate.account, 100, body, alice.permission);
+            await contract.sendreq(alice.account, kate.account, 102, "other", alice.permission);
+            assert.equal(2, Number((await util.getRequestPayload(hash)).refs));
+            const rows = await util.getRequestsLog();
+            assert.deepEqual([body, body, "other"], rows.map(r => r.request));
+
+            await contract.setretention(1, aggregion.permission);
+            await contract.migrate('reqslog', 10, aggregion.permission);
+            await contract.prunereqs(101, 1, aggregion.permission);
+            assert.equal(1, Number((await util.getRequestPayload(hash)).refs));
+            await contract.prunereqs(101, 1, aggregion.permission);
+            assert.isUndefined(await util.getRequestPayload(hash));
+        });
+        it('should prune requests outside retention window with checkpoint', async () => {
+            const alice = await tools.makeAccount(bc, 'alice');
+            const jimbo = await tools.makeAccount(bc, 'jimbo');
+            const now = Math.floor(Date.now() / 1000);
+            await contract.sendreq(alice.account, jimbo.account, now - 999, "my request 2", alice.permission);
+            await contract.sendreq(alice.account, jimbo.account, now - 1000, "my request 1", alice.permission);
+            await contract.sendreq(alice.account, jimbo.account, now + 1000, "my request 3", alice.permission);
+            await contract.prunereqs(now - 995, 10, aggregion.permission)
+                .should.be.rejectedWith('403. Retention is not configured!');
+            await contract.setretention(100, alice.permission)
+                .should.be.rejected;
+            await contract.setretention(100, aggregion.permission);
+            await contract.prunereqs(now - 995, 10, aggregion.permission)
+                .should.be.rejectedWith('403. Requests log is not migrated!');
+            await contract.migrate('reqslog', 10, aggregion.permission);
+            // Future dated request doesn't move retention window.
+            await contract.prunereqs(now - 50, 10, aggregion.permission)
+                .should.be.rejectedWith('403. Date is inside retention window!');
+
+            await contract.prunereqs(now - 995, 1, aggregion.permission);
+            await contract.prunereqs(now - 995, 1, aggregion.permission);
+            await contract.prunereqs(now - 995, 1, aggregion.permission);
+            const rows = await util.getRequestsLog();
+            assert.deepEqual([now + 1000], rows.map(r => Number(r.date)));
+
+            let digest = '0'.repeat(64);
+            digest = KeysUtility.hashKeys(digest, KeysUtility.makeRequestKey(alice.account, jimbo.account, now - 1000, "my request 1"));
+            digest = KeysUtility.hashKeys(digest, KeysUtility.makeRequestKey(alice.account, jimbo.account, now - 999, "my request 2"));
+            const checkpoints = await util.getRequestsCheckpoints();
+            assert.equal(2, checkpoints.length);
+            assert.equal(digest, checkpoints[1].digest);
+            const config = await util.getRequestsConfig();
+            assert.equal(digest, config.checkpoint);
+            assert.equal(2, Number(config.pruned_count));
+
+            await contract.sendreq(alice.account, jimbo.account, now - 1000, "my request 1", alice.permission)
+                .should.be.rejectedWith('403. Request date is out of retention window!');
+            await contract.sendreq(alice.account, jimbo.account, now + 1000, "my request 3", alice.permission)
+                .should.be.rejected;
+            await contract.sendreq(alice.account, jimbo.account, now - 990, "my request 4", alice.permission);
+        });
+        it('should order and prune negative request dates first', async () => {
+            const alice = await tools.makeAccount(bc, 'alice');
+            const jimbo = await tools.makeAccount(bc, 'jimbo');
+            await contract.sendreq(alice.account, jimbo.account, 5, "my request 2", alice.permission);
+            await contract.sendreq(alice.account, jimbo.account, -1, "my request 1", alice.permission);
+            const inbound = await util.getRequestsByReceiver(jimbo.account, -10, 10);
+            assert.deepEqual([-1, 5], inbound.map(r => Number(r.date)));
+
+            await contract.setretention(100, aggregion.permission);
+            await contract.migrate('reqslog', 10, aggregion.permission);
+            await contract.prunereqs(0, 10, aggregion.permission);
+            const rows = await util.getRequestsLog();
+            assert.deepEqual([5], rows.map(r => Number(r.date)));
+        });
     });
 
 });
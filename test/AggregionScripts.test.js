@@ -3,6 +3,8 @@ const AggregionBlockchain = require('../js/AggregionBlockchain.js');
 const AggregionNode = require('../js/AggregionNode.js');
 const AggregionContract = require('../js/AggregionContract.js');
 const AggregionUtility = require('../js/AggregionUtility.js');
+const RulesProof = require('../js/RulesProof.js');
+const EnclaveSnapshot = require('../js/EnclaveSnapshot.js');
 const TestConfig = require('./TestConfig.js');
 const tools = require('./TestTools.js');
 
@@ -28,6 +30,7 @@ describe('AggregionScripts', function () {
 
     beforeEach(async function () {
         await node.start();
+        await tools.activateFeatures(bc, config);
         aggregion = await tools.makeAccount(bc, contractConfig.account);
         await bc.deploy(aggregion.account, contractConfig.wasm, contractConfig.abi, aggregion.permission);
     });
@@ -128,6 +131,50 @@ describe('AggregionScripts', function () {
             await contract.addscript('alice', 'script2', 'v2', 'Einstein function', hashOne, 'http://eindef.com', alice.permission)
                 .should.be.rejected;
         });
+        it('should find scripts after keys migration', async function () {
+            const alice = await tools.makeAccount(bc, 'alice');
+            await tools.upgradeFromBaseline(this, bc, config, aggregion, async () => {
+                await contract.addscript(alice.account, 'script1', 'v1', 'Newton function', hashOne, 'http://example.com', alice.permission);
+                await contract.addscript(alice.account, 'script1', 'v2', 'Einstein function', hashTwo, 'http://eindef.com', alice.permission);
+            });
+            assert.isUndefined((await util.getScript(alice.account, 'script1', 'v1')).keys_version);
+            await contract.migrate('scripts', 10, aggregion.permission);
+            await contract.migrate('scripts', 10, aggregion.permission)
+                .should.be.rejectedWith('403. Table is already migrated!');
+            for (const [version, hash] of [['v1', hashOne], ['v2', hashTwo]]) {
+                const script = await util.getScript(alice.account, 'script1', version);
+                assert.equal(hash, script.hash);
+                assert.equal(2, script.keys_version);
+            }
+            await contract.addscript(alice.account, 'script1', 'v2', 'Einstein function', hashTwo, 'http://eindef.com', alice.permission)
+                .should.be.rejected;
+        });
+        it('should list script versions and find latest one', async () => {
+            const alice = await tools.makeAccount(bc, 'alice');
+            const bob = await tools.makeAccount(bc, 'bob');
+            await contract.latestscript(alice.account, 'script1', alice.permission)
+                .should.be.rejectedWith('404. Script not found');
+            await contract.addscript(alice.account, 'script1', 'v1', 'Newton function', hashOne, 'http://example.com', alice.permission);
+            await contract.addscript(bob.account, 'script1', 'v3', 'Foreign function', hashTwo, 'http://example.com', bob.permission);
+            await contract.addscript(alice.account, 'script2', 'v1', 'Other function', 'ab'.repeat(32), 'http://example.com', alice.permission);
+            await contract.addscript(alice.account, 'script1', 'v2', 'Einstein function', 'cd'.repeat(32), 'http://eindef.com', alice.permission);
+
+            const versions = await util.getScriptVersions(alice.account, 'script1');
+            assert.deepEqual(['v1', 'v2'], versions.map(s => s.version));
+            const latest = await contract.latestscript(alice.account, 'script1', alice.permission);
+            assert.equal('v2', latest.version);
+            assert.equal('Einstein function', latest.description);
+
+            await contract.remscript(alice.account, 'script1', 'v2', alice.permission);
+            assert.equal('v1', (await contract.latestscript(alice.account, 'script1', alice.permission)).version);
+        });
+        it('should find highest script version regardless of insertion order', async () => {
+            const alice = await tools.makeAccount(bc, 'alice');
+            await contract.addscript(alice.account, 'script1', 'v3', 'Third', hashOne, 'http://example.com', alice.permission);
+            await contract.addscript(alice.account, 'script1', 'v2', 'Second', hashTwo, 'http://example.com', alice.permission);
+            await contract.addscript(alice.account, 'script2', 'v4', 'Other', 'ab'.repeat(32), 'http://example.com', alice.permission);
+            assert.equal('v3', (await contract.latestscript(alice.account, 'script1', alice.permission)).version);
+        });
     });
 
     describe('#providers trust', function () {
@@ -196,7 +243,76 @@ describe('AggregionScripts', function () {
             assert.isTrue(await util.isTrusted(kate.account, john.account));
             await contract.unregprov(john.account, john.permission);
             assert.isFalse(await util.isTrusted(john.account, kate.account));
-            assert.isTrue(await util.isTrusted(kate.account, john.account));
+            assert.isFalse(await util.isTrusted(kate.account, john.account));
+            assert.deepEqual([], await util.getTrusters(kate.account));
+        });
+        it('should list providers trusting given provider', async () => {
+            const john = await tools.makeAccount(bc, 'john');
+            const kate = await tools.makeAccount(bc, 'kate');
+            const bob = await tools.makeAccount(bc, 'bob');
+            await contract.regprov(john.account, 'John provider', john.permission);
+            await contract.regprov(kate.account, 'Kate provider', kate.permission);
+            await contract.regprov(bob.account, 'Bob provider', bob.permission);
+            await contract.trust(john.account, kate.account, john.permission);
+            await contract.trust(bob.account, kate.account, bob.permission);
+            await contract.trust(kate.account, john.account, kate.permission);
+            assert.deepEqual([bob.account, john.account], await util.getTrusters(kate.account));
+            await contract.untrust(bob.account, kate.account, bob.permission);
+            assert.deepEqual([john.account], await util.getTrusters(kate.account));
+            assert.deepEqual([kate.account], await util.getTrusters(john.account));
+        });
+        it('should migrate trusters mirror by trust statements', async function () {
+            const john = await tools.makeAccount(bc, 'john');
+            const kate = await tools.makeAccount(bc, 'kate');
+            const bob = await tools.makeAccount(bc, 'bob');
+            await tools.upgradeFromBaseline(this, bc, config, aggregion, async () => {
+                await contract.regprov(john.account, 'John provider', john.permission);
+                await contract.regprov(kate.account, 'Kate provider', kate.permission);
+                await contract.regprov(bob.account, 'Bob provider', bob.permission);
+                await contract.trust(john.account, kate.account, john.permission);
+                await contract.trust(john.account, bob.account, john.permission);
+                await contract.trust(bob.account, kate.account, bob.permission);
+            });
+            assert.deepEqual([], await util.getTrusters(kate.account));
+
+            // Three statements and three providers, one per call.
+            for (let i = 0; i < 7; ++i) {
+                await contract.migrate('trustedprov', 1, aggregion.permission);
+            }
+            await contract.migrate('trustedprov', 1, aggregion.permission)
+                .should.be.rejectedWith('403. Table is already migrated!');
+            assert.deepEqual([bob.account, john.account], await util.getTrusters(kate.account));
+            assert.deepEqual([john.account], await util.getTrusters(bob.account));
+        });
+        it('should count approves of provider trusted by many providers in batches', async () => {
+            const kate = await tools.makeAccount(bc, 'kate');
+            await contract.regprov(kate.account, 'Kate provider', kate.permission);
+            const toName = (i) => 'tr' + [...i.toString(5)].map(d => 'abcde'[d]).join('');
+            let trusters = [];
+            for (let i = 0; i <= 100; ++i) {
+                const truster = await tools.makeAccount(bc, toName(i));
+                await contract.regprov(truster.account, 'Truster', truster.permission);
+                await contract.trust(truster.account, kate.account, truster.permission);
+                trusters.push(truster);
+            }
+            await contract.addscript(kate.account, 's1', 'v1', 'ABC', hashOne, 'http://example.com', kate.permission);
+            const [script] = await util.getScriptByHash(hashOne);
+            await contract.execapprove(kate.account, hashOne, kate.permission);
+
+            // Approve is counted for first 100 trusters inline, the rest waits in queue.
+            assert.equal(1, (await util.getTrustUpdates()).length);
+            assert.equal(1, await util.getTrustedApproves(trusters[0].account, script.id));
+            assert.equal(0, await util.getTrustedApproves(trusters[100].account, script.id));
+            await contract.synctrust(10, aggregion.permission);
+            assert.equal(0, (await util.getTrustUpdates()).length);
+            assert.equal(1, await util.getTrustedApproves(trusters[100].account, script.id));
+
+            await contract.unregprov(kate.account, kate.permission);
+            await contract.cleanup(kate.account, 1000, aggregion.permission);
+            assert.equal(0, (await util.getTrustUpdates()).length);
+            for (const truster of [trusters[0], trusters[100]]) {
+                assert.equal(0, await util.getTrustedApproves(truster.account, script.id));
+            }
         });
     });
 
@@ -259,6 +375,118 @@ describe('AggregionScripts', function () {
             await contract.execdeny('alice', hashOne, alice.permission);
             await contract.remscript(alice.account, 'script1', 'v1', alice.permission);
         });
+        it('should remove script rules with script', async () => {
+            const alice = await tools.makeAccount(bc, 'alice');
+            const bob = await tools.makeAccount(bc, 'bob');
+            await contract.regprov(alice.account, 'Alice provider', alice.permission);
+            await contract.regprov(bob.account, 'Bob provider', bob.permission);
+            await contract.addscript(alice.account, 'script1', 'v1', 'Description', hashOne, 'Url', alice.permission);
+            const [script] = await util.getScriptByHash(hashOne);
+            await contract.execdeny(bob.account, hashOne, bob.permission);
+            await contract.grantaccess(alice.account, hashOne, bob.account, alice.permission);
+            await contract.grantaccess(alice.account, hashOne, alice.account, alice.permission);
+            assert.deepEqual([bob.account], (await util.getScriptApprovers(script.id)).map(r => r.provider));
+            assert.deepEqual([alice.account, bob.account], (await util.getScriptGrantees(script.id)).map(r => r.grantee));
+
+            const expiresAt = Math.floor(Date.now() / 1000) + 3600;
+            await contract.enclaveScriptAccess(bob.account, hashOne, alice.account, true, bob.permission, expiresAt);
+            assert.equal(1, (await util.getGrantsExpiry()).length);
+
+            await contract.remscript(alice.account, 'script1', 'v1', alice.permission);
+            assert.deepEqual([], await util.getScriptApprovers(script.id));
+            assert.deepEqual([], await util.getScriptGrantees(script.id));
+            const access = await bc.getTableRows(aggregion.account, 'scriptaccess', bob.account);
+            assert.equal(0, access.rows.length);
+            const approves = await bc.getTableRows(aggregion.account, 'approves', bob.account);
+            assert.equal(0, approves.rows.length);
+            assert.isUndefined(await util.getEnclaveAccess(bob.account, script.id, alice.account));
+            assert.equal(0, (await util.getGrantsExpiry()).length);
+            const enclaves = await bc.getTableRows(aggregion.account, 'screnclaves', script.id);
+            assert.equal(0, enclaves.rows.length);
+        });
+        it('should remove enclave permissions of script in batches', async () => {
+            const alice = await tools.makeAccount(bc, 'alice');
+            const bob = await tools.makeAccount(bc, 'bob');
+            await contract.regprov(alice.account, 'Alice provider', alice.permission);
+            await contract.addscript(alice.account, 'script1', 'v1', 'Description', hashOne, 'Url', alice.permission);
+            const [script] = await util.getScriptByHash(hashOne);
+            const toName = (i) => [...i.toString(5)].map(d => String.fromCharCode(97 + Number(d))).join('');
+            const grantees = [...Array(101).keys()].map(i => 'g' + toName(i));
+            for (let i = 0; i < grantees.length; i += 25) {
+                await contract.encgrantmany(bob.account, [hashOne], grantees.slice(i, i + 25), true, bob.permission);
+            }
+
+            await contract.remscript(alice.account, 'script1', 'v1', alice.permission);
+            await contract.updscript(alice.account, 'script1', 'v1', 'Updated', hashOne, 'Url', alice.permission)
+                .should.be.rejectedWith('403. Script is being removed!');
+            await contract.enclaveScriptAccess(bob.account, hashOne, alice.account, true, bob.permission)
+                .should.be.rejectedWith('403. Script is being removed!');
+            await contract.remscript(alice.account, 'script1', 'v1', alice.permission);
+            assert.isUndefined(await util.getEnclaveAccess(bob.account, script.id, grantees[100]));
+            const access = await bc.getTableRows(aggregion.account, 'encaccess', bob.account);
+            assert.equal(0, access.rows.length);
+            assert.equal(0, (await util.getScriptByHash(hashOne)).length);
+        });
+        it('should not reuse id of removed script', async () => {
+            const alice = await tools.makeAccount(bc, 'alice');
+            const bob = await tools.makeAccount(bc, 'bob');
+            await contract.regprov(alice.account, 'Alice provider', alice.permission);
+            await contract.regprov(bob.account, 'Bob provider', bob.permission);
+            await contract.addscript(alice.account, 'script1', 'v1', 'Description', hashOne, 'Url', alice.permission);
+            const [script1] = await util.getScriptByHash(hashOne);
+            await contract.enclaveScriptAccess(bob.account, hashOne, alice.account, true, bob.permission);
+            await contract.remscript(alice.account, 'script1', 'v1', alice.permission);
+
+            await contract.addscript(alice.account, 'script2', 'v1', 'Description', hashTwo, 'Url', alice.permission);
+            const [script2] = await util.getScriptByHash(hashTwo);
+            assert.notEqual(Number(script1.id), Number(script2.id));
+            const verdict = await contract.canexec(bob.account, hashTwo, alice.account, bob.permission);
+            assert.notOk(verdict.enclave_access);
+        });
+        it('should migrate script approvers and grantees mirrors per rule', async function () {
+            const alice = await tools.makeAccount(bc, 'alice');
+            const bob = await tools.makeAccount(bc, 'bob');
+            await tools.upgradeFromBaseline(this, bc, config, aggregion, async () => {
+                await contract.regprov(alice.account, 'Alice provider', alice.permission);
+                await contract.regprov(bob.account, 'Bob provider', bob.permission);
+                await contract.addscript(alice.account, 'script1', 'v1', 'Description', hashOne, 'Url', alice.permission);
+                await contract.addscript(alice.account, 'script2', 'v1', 'Description', hashTwo, 'Url', alice.permission);
+                await contract.execapprove(bob.account, hashOne, bob.permission);
+                await contract.execdeny(bob.account, hashTwo, bob.permission);
+                await contract.grantaccess(alice.account, hashOne, bob.account, alice.permission);
+                await contract.grantaccess(alice.account, hashTwo, bob.account, alice.permission);
+            });
+            const [script1] = await util.getScriptByHash(hashOne);
+            const [script2] = await util.getScriptByHash(hashTwo);
+            assert.equal(0, (await util.getScriptApprovers(script1.id)).length);
+            assert.equal(0, (await util.getScriptGrantees(script1.id)).length);
+
+            // Alice has no rules, bob has two of each kind: [alice, rule], [rule, bob], [].
+            for (const table of ['approves', 'scriptaccess']) {
+                for (let i = 0; i < 3; ++i) {
+                    await contract.migrate(table, 2, aggregion.permission);
+                }
+                await contract.migrate(table, 2, aggregion.permission)
+                    .should.be.rejectedWith('403. Table is already migrated!');
+            }
+            assert.deepEqual([bob.account], (await util.getScriptApprovers(script1.id)).map(r => r.provider));
+            assert.deepEqual([bob.account], (await util.getScriptApprovers(script2.id)).map(r => r.provider));
+            assert.deepEqual([bob.account], (await util.getScriptGrantees(script1.id)).map(r => r.grantee));
+            assert.deepEqual([bob.account], (await util.getScriptGrantees(script2.id)).map(r => r.grantee));
+        });
+        it('should count approve of provider once', async () => {
+            const alice = await tools.makeAccount(bc, 'alice');
+            await contract.regprov('alice', 'Alice provider', alice.permission);
+            await contract.addscript(alice.account, 'script1', 'v1', 'Description', hashOne, 'Url', alice.permission);
+            await contract.execdeny('alice', hashOne, alice.permission);
+            await contract.execapprove('alice', hashOne, alice.permission);
+            await contract.execapprove('alice', hashOne, alice.permission);
+            const [script] = await util.getScriptByHash(hashOne);
+            assert.equal(1, (await util.getScriptStats(script.id)).approves_count);
+            await contract.execdeny('alice', hashOne, alice.permission);
+            assert.equal(0, (await util.getScriptStats(script.id)).approves_count);
+            await contract.updscript(alice.account, 'script1', 'v1', 'Newton function', hashTwo, 'http://example.com', alice.permission);
+        });
         it('should remove approve statements if provider was removed', async () => {
             const john = await tools.makeAccount(bc, 'john');
             const kate = await tools.makeAccount(bc, 'kate');
@@ -347,6 +575,94 @@ describe('AggregionScripts', function () {
             assert.isUndefined(await util.isScriptAccessGrantedTo(john.account, hashOne));
             assert.isTrue(await util.isScriptAccessGrantedTo(kate.account, hashOne));
         });
+        it('should deny and sweep expired access', async () => {
+            const eown = await tools.makeAccount(bc, 'eown');
+            const sown = await tools.makeAccount(bc, 'sown');
+            const prov = await tools.makeAccount(bc, 'prov');
+            await contract.regprov(eown.account, 'Enclave Owner', eown.permission);
+            await contract.regprov(prov.account, 'Some Provider', prov.permission);
+            await contract.addscript(sown.account, 's1', 'v1', 'ABC', hashOne, 'http://example.com', sown.permission);
+            const past = Math.floor(Date.now() / 1000) - 10;
+            await contract.grantaccess(sown.account, hashOne, prov.account, sown.permission, past)
+                .should.be.rejectedWith('403. Grant expiry must be in the future!');
+            await contract.enclaveScriptAccess(eown.account, hashOne, prov.account, false, eown.permission, past + 100)
+                .should.be.rejectedWith('403. Expiry is allowed for granted access only!');
+
+            const expiresAt = Math.floor(Date.now() / 1000) + 2;
+            await contract.grantaccess(sown.account, hashOne, prov.account, sown.permission, expiresAt);
+            await contract.enclaveScriptAccess(eown.account, hashOne, prov.account, true, eown.permission, expiresAt);
+            let verdict = await contract.canexec(eown.account, hashOne, prov.account, eown.permission);
+            assert.isTrue(verdict.grantee_access);
+            assert.isTrue(verdict.enclave_access);
+            assert.equal(2, (await util.getGrantsExpiry()).length);
+
+            await new Promise(resolve => setTimeout(resolve, 3000));
+            verdict = await contract.canexec(eown.account, hashOne, prov.account, eown.permission);
+            assert.isFalse(verdict.grantee_access);
+            assert.isFalse(verdict.enclave_access);
+            assert.isFalse(await util.isScriptAllowedWithinEnclave(eown.account, hashOne, prov.account));
+
+            await contract.sweepgrants(1, prov.permission);
+            await contract.sweepgrants(10, prov.permission);
+            assert.equal(0, (await util.getGrantsExpiry()).length);
+            assert.isUndefined(await util.isScriptAllowedWithinEnclave(eown.account, hashOne, prov.account));
+            const access = await bc.getTableRows(aggregion.account, 'scriptaccess', prov.account);
+            assert.equal(0, access.rows.length);
+            assert.equal(0, Number((await util.getProviderStats(prov.account)).grants));
+        });
+        it('should keep renewed access', async () => {
+            const sown = await tools.makeAccount(bc, 'sown');
+            const prov = await tools.makeAccount(bc, 'prov');
+            await contract.regprov(prov.account, 'Some Provider', prov.permission);
+            await contract.addscript(sown.account, 's1', 'v1', 'ABC', hashOne, 'http://example.com', sown.permission);
+            await contract.grantaccess(sown.account, hashOne, prov.account, sown.permission, Math.floor(Date.now() / 1000) + 2);
+            await contract.grantaccess(sown.account, hashOne, prov.account, sown.permission);
+            assert.equal(0, (await util.getGrantsExpiry()).length);
+
+            await new Promise(resolve => setTimeout(resolve, 3000));
+            await contract.sweepgrants(10, prov.permission);
+            const access = await bc.getTableRows(aggregion.account, 'scriptaccess', prov.account);
+            assert.equal(1, access.rows.length);
+            assert.equal(1, access.rows[0].granted);
+        });
+        it('should set access of many grantees to many scripts', async () => {
+            const sown = await tools.makeAccount(bc, 'sown');
+            const eown = await tools.makeAccount(bc, 'eown');
+            const prv1 = await tools.makeAccount(bc, 'prv1');
+            const prv2 = await tools.makeAccount(bc, 'prv2');
+            await contract.regprov(prv1.account, 'Provider 1', prv1.permission);
+            await contract.regprov(prv2.account, 'Provider 2', prv2.permission);
+            await contract.addscript(sown.account, 's1', 'v1', 'ABC', hashOne, 'http://example.com', sown.permission);
+            await contract.addscript(sown.account, 's1', 'v2', 'ABC', hashTwo, 'http://example.com', sown.permission);
+            const hashes = [hashOne, hashTwo];
+            const grantees = [prv1.account, prv2.account];
+            await contract.grantmany(sown.account, hashes, [prv1.account, eown.account], true, sown.permission)
+                .should.be.rejectedWith('404. Provider (grantee) not found');
+            await contract.grantmany(prv1.account, hashes, grantees, true, prv1.permission)
+                .should.be.rejectedWith('403. Script owner mismatch');
+            const manyHashes = Array.from({ length: 251 }, () => hashOne);
+            await contract.grantmany(sown.account, manyHashes, grantees, true, sown.permission)
+                .should.be.rejectedWith('403. Too many grants in batch!');
+            await contract.encgrantmany(eown.account, manyHashes, grantees, true, eown.permission)
+                .should.be.rejectedWith('403. Too many grants in batch!');
+
+            await contract.grantmany(sown.account, hashes, grantees, true, sown.permission);
+            const [script1] = await util.getScriptByHash(hashOne);
+            const [script2] = await util.getScriptByHash(hashTwo);
+            assert.deepEqual(grantees, (await util.getScriptGrantees(script1.id)).map(r => r.grantee));
+            assert.deepEqual(grantees, (await util.getScriptGrantees(script2.id)).map(r => r.grantee));
+            assert.equal(2, Number((await util.getProviderStats(prv2.account)).grants));
+
+            await contract.grantmany(sown.account, [hashTwo], [prv2.account], false, sown.permission);
+            assert.equal(1, Number((await util.getProviderStats(prv2.account)).grants));
+
+            await contract.encgrantmany(eown.account, hashes, grantees, true, eown.permission);
+            for (const hash of hashes) {
+                for (const grantee of grantees) {
+                    assert.isTrue(await util.isScriptAllowedWithinEnclave(eown.account, hash, grantee));
+                }
+            }
+        });
     });
 
 
@@ -434,5 +750,221 @@ describe('AggregionScripts', function () {
             assert.isUndefined(await util.isScriptAllowedWithinEnclave(eown.account, hashOne, prov.account));
             assert.isTrue(await util.isScriptAllowedWithinEnclave(eow2.account, hashOne, prov.account));
         });
+        it('should keep grantees of script in separate rows', async () => {
+            const eown = await tools.makeAccount(bc, 'eown');
+            const sown = await tools.makeAccount(bc, 'sown');
+            const prv1 = await tools.makeAccount(bc, 'prv1');
+            const prv2 = await tools.makeAccount(bc, 'prv2');
+            await contract.regprov(eown.account, 'Enclave Owner', eown.permission);
+            await contract.addscript(sown.account, 's1', 'v1', 'ABC', hashOne, 'http://example.com', sown.permission);
+            await contract.enclaveScriptAccess(eown.account, hashOne, prv1.account, true, eown.permission);
+            await contract.enclaveScriptAccess(eown.account, hashOne, prv2.account, false, eown.permission);
+            const [script] = await util.getScriptByHash(hashOne);
+            assert.equal(1, (await util.getEnclaveAccess(eown.account, script.id, prv1.account)).granted);
+            assert.equal(0, (await util.getEnclaveAccess(eown.account, script.id, prv2.account)).granted);
+            assert.isTrue(await util.isScriptAllowedWithinEnclave(eown.account, hashOne, prv1.account));
+            assert.isFalse(await util.isScriptAllowedWithinEnclave(eown.account, hashOne, prv2.account));
+        });
+        it('should move enclave permissions written before upgrade', async function () {
+            const eown = await tools.makeAccount(bc, 'eown');
+            const sown = await tools.makeAccount(bc, 'sown');
+            const prv1 = await tools.makeAccount(bc, 'prv1');
+            const prv2 = await tools.makeAccount(bc, 'prv2');
+            const prv3 = await tools.makeAccount(bc, 'prv3');
+            await tools.upgradeFromBaseline(this, bc, config, aggregion, async () => {
+                await contract.regprov(eown.account, 'Enclave Owner', eown.permission);
+                await contract.addscript(sown.account, 's1', 'v1', 'ABC', hashOne, 'http://example.com', sown.permission);
+                await contract.enclaveScriptAccess(eown.account, hashOne, prv1.account, true, eown.permission);
+                await contract.enclaveScriptAccess(eown.account, hashOne, prv2.account, false, eown.permission);
+                await contract.enclaveScriptAccess(eown.account, hashOne, prv3.account, true, eown.permission);
+            });
+            const [script] = await util.getScriptByHash(hashOne);
+            assert.isUndefined(await util.getEnclaveAccess(eown.account, script.id, prv1.account));
+            assert.isTrue(await util.isScriptAllowedWithinEnclave(eown.account, hashOne, prv1.account));
+
+            // Permission written after upgrade has precedence over legacy one.
+            await contract.enclaveScriptAccess(eown.account, hashOne, prv3.account, false, eown.permission);
+            await contract.migrateesa(eown.account, 2, aggregion.permission);
+            await contract.migrateesa(eown.account, 2, aggregion.permission);
+            assert.equal(0, (await bc.getTableRows(aggregion.account, 'encscraccess', eown.account)).rows.length);
+            assert.equal(1, (await util.getEnclaveAccess(eown.account, script.id, prv1.account)).granted);
+            assert.equal(0, (await util.getEnclaveAccess(eown.account, script.id, prv2.account)).granted);
+            assert.equal(0, (await util.getEnclaveAccess(eown.account, script.id, prv3.account)).granted);
+        });
+        it('should return enclave permissions snapshot', async () => {
+            const eown = await tools.makeAccount(bc, 'eown');
+            const sown = await tools.makeAccount(bc, 'sown');
+            const prv1 = await tools.makeAccount(bc, 'prv1');
+            const prv2 = await tools.makeAccount(bc, 'prv2');
+            await contract.addscript(sown.account, 's1', 'v1', 'ABC', hashOne, 'http://example.com', sown.permission);
+            await contract.addscript(sown.account, 's1', 'v2', 'ABC', hashTwo, 'http://example.com', sown.permission);
+            const [script1] = await util.getScriptByHash(hashOne);
+            const [script2] = await util.getScriptByHash(hashTwo);
+            await contract.enclaveScriptAccess(eown.account, hashOne, prv1.account, true, eown.permission);
+            await contract.enclaveScriptAccess(eown.account, hashOne, prv2.account, false, eown.permission);
+            await contract.enclaveScriptAccess(eown.account, hashTwo, prv2.account, true, eown.permission);
+
+            const result = await contract.encsnapshot(eown.account, eown.permission);
+            assert.equal(2, result.scripts.length);
+            assert.deepEqual([prv1.account, prv2.account], result.grantees);
+            assert.equal(0, Number(result.valid_until));
+            const snapshot = new EnclaveSnapshot(result);
+            assert.isTrue(snapshot.isGranted(script1.id, prv1.account));
+            assert.isFalse(snapshot.isGranted(script1.id, prv2.account));
+            assert.isUndefined(snapshot.isGranted(script2.id, prv1.account));
+            assert.isTrue(snapshot.isGranted(script2.id, prv2.account));
+            assert.isUndefined(snapshot.isGranted(script2.id, sown.account));
+        });
+    });
+
+
+    describe('#execution check', function () {
+        it('should report unknown script', async () => {
+            const eown = await tools.makeAccount(bc, 'eown');
+            const prov = await tools.makeAccount(bc, 'prov');
+            const verdict = await contract.canexec(eown.account, hashOne, prov.account, eown.permission);
+            assert.isFalse(verdict.script_found);
+        });
+        it('should resolve all execution rules at once', async () => {
+            const eown = await tools.makeAccount(bc, 'eown');
+            const sown = await tools.makeAccount(bc, 'sown');
+            const prov = await tools.makeAccount(bc, 'prov');
+            await contract.regprov(eown.account, 'Enclave Owner', eown.permission);
+            await contract.regprov(sown.account, 'Script Owner', sown.permission);
+            await contract.regprov(prov.account, 'Some Provider', prov.permission);
+            await contract.addscript(sown.account, 's1', 'v1', 'ABC', hashOne, 'http://example.com', sown.permission);
+            await contract.enclaveScriptAccess(eown.account, hashOne, prov.account, true, eown.permission);
+            await contract.grantaccess(sown.account, hashOne, prov.account, sown.permission);
+            await contract.execapprove(eown.account, hashOne, eown.permission);
+            await contract.trust(eown.account, sown.account, eown.permission);
+            const verdict = await contract.canexec(eown.account, hashOne, prov.account, eown.permission);
+            assert.isTrue(verdict.script_found);
+            assert.equal(sown.account, verdict.script_owner);
+            assert.isTrue(verdict.enclave_access);
+            assert.isTrue(verdict.grantee_access);
+            assert.isTrue(verdict.owner_approved);
+            assert.isFalse(verdict.owner_trusts_grantee);
+            assert.isTrue(verdict.owner_trusts_script_owner);
+            assert.equal(0, Number(verdict.trusted_approves));
+        });
+        it('should count approves of trusted providers', async () => {
+            const eown = await tools.makeAccount(bc, 'eown');
+            const sown = await tools.makeAccount(bc, 'sown');
+            const prov = await tools.makeAccount(bc, 'prov');
+            await contract.regprov(eown.account, 'Enclave Owner', eown.permission);
+            await contract.regprov(sown.account, 'Script Owner', sown.permission);
+            await contract.regprov(prov.account, 'Some Provider', prov.permission);
+            await contract.addscript(sown.account, 's1', 'v1', 'ABC', hashOne, 'http://example.com', sown.permission);
+            const [script] = await util.getScriptByHash(hashOne);
+
+            await contract.execapprove(sown.account, hashOne, sown.permission);
+            await contract.trust(eown.account, sown.account, eown.permission);
+            assert.equal(1, await util.getTrustedApproves(eown.account, script.id));
+            await contract.trust(eown.account, prov.account, eown.permission);
+            await contract.execapprove(prov.account, hashOne, prov.permission);
+            await contract.execapprove(prov.account, hashOne, prov.permission);
+            assert.equal(2, await util.getTrustedApproves(eown.account, script.id));
+            assert.equal(2, Number((await contract.canexec(eown.account, hashOne, prov.account, eown.permission)).trusted_approves));
+
+            await contract.untrust(eown.account, sown.account, eown.permission);
+            assert.equal(1, await util.getTrustedApproves(eown.account, script.id));
+            await contract.unregprov(prov.account, prov.permission);
+            assert.equal(0, await util.getTrustedApproves(eown.account, script.id));
+        });
+        it('should recount trusted approves one row per call', async function () {
+            const eown = await tools.makeAccount(bc, 'eown');
+            const sown = await tools.makeAccount(bc, 'sown');
+            const prov = await tools.makeAccount(bc, 'prov');
+            await tools.upgradeFromBaseline(this, bc, config, aggregion, async () => {
+                await contract.regprov(eown.account, 'Enclave Owner', eown.permission);
+                await contract.regprov(sown.account, 'Script Owner', sown.permission);
+                await contract.regprov(prov.account, 'Some Provider', prov.permission);
+                await contract.addscript(sown.account, 's1', 'v1', 'ABC', hashOne, 'http://example.com', sown.permission);
+                await contract.execapprove(sown.account, hashOne, sown.permission);
+                await contract.execapprove(prov.account, hashOne, prov.permission);
+                await contract.trust(eown.account, sown.account, eown.permission);
+                await contract.trust(eown.account, prov.account, eown.permission);
+            });
+            const [script] = await util.getScriptByHash(hashOne);
+            assert.equal(0, await util.getTrustedApproves(eown.account, script.id));
+
+            let calls = 0;
+            for (; calls < 20; ++calls) {
+                const done = await contract.migrate('trustapprvs', 1, aggregion.permission)
+                    .then(() => false, () => true);
+                if (done)
+                    break;
+            }
+            // Two trust statements, two approves and three providers.
+            assert.equal(8, calls);
+            assert.equal(4, (await util.getTrustUpdates()).length);
+            await contract.synctrust(100, aggregion.permission);
+            assert.equal(0, (await util.getTrustUpdates()).length);
+            assert.equal(2, await util.getTrustedApproves(eown.account, script.id));
+        });
+        it('should count trust changes once while trusted approves are queued', async function () {
+            const eown = await tools.makeAccount(bc, 'eown');
+            const prov = await tools.makeAccount(bc, 'prov');
+            const sown = await tools.makeAccount(bc, 'sown');
+            const xown = await tools.makeAccount(bc, 'xown');
+            await tools.upgradeFromBaseline(this, bc, config, aggregion, async () => {
+                for (const p of [eown, prov, sown, xown]) {
+                    await contract.regprov(p.account, 'Provider', p.permission);
+                }
+                await contract.addscript(sown.account, 's1', 'v1', 'ABC', hashOne, 'http://example.com', sown.permission);
+                for (const p of [prov, sown, xown]) {
+                    await contract.execapprove(p.account, hashOne, p.permission);
+                }
+                await contract.trust(eown.account, prov.account, eown.permission);
+                await contract.trust(eown.account, sown.account, eown.permission);
+            });
+            const [script] = await util.getScriptByHash(hashOne);
+
+            // Migration queues trust of 'prov' before it is revoked and trust of 'xown' once more.
+            await contract.migrate('trustapprvs', 1, aggregion.permission);
+            await contract.untrust(eown.account, prov.account, eown.permission);
+            await contract.trust(eown.account, xown.account, eown.permission);
+            for (let calls = 0; calls < 20; ++calls) {
+                const done = await contract.migrate('trustapprvs', 1, aggregion.permission)
+                    .then(() => false, () => true);
+                if (done)
+                    break;
+            }
+            await contract.synctrust(100, aggregion.permission);
+            assert.equal(2, await util.getTrustedApproves(eown.account, script.id));
+        });
+        it('should prove execution rules', async () => {
+            const eown = await tools.makeAccount(bc, 'eown');
+            const sown = await tools.makeAccount(bc, 'sown');
+            const prov = await tools.makeAccount(bc, 'prov');
+            await contract.migrate('sarleaves', 10, aggregion.permission);
+            await contract.regprov(eown.account, 'Enclave Owner', eown.permission);
+            await contract.regprov(sown.account, 'Script Owner', sown.permission);
+            await contract.regprov(prov.account, 'Some Provider', prov.permission);
+            await contract.addscript(sown.account, 's1', 'v1', 'ABC', hashOne, 'http://example.com', sown.permission);
+            await contract.trust(eown.account, sown.account, eown.permission);
+            await contract.execapprove(eown.account, hashOne, eown.permission);
+            await contract.grantaccess(sown.account, hashOne, prov.account, sown.permission);
+            await contract.enclaveScriptAccess(eown.account, hashOne, prov.account, true, eown.permission);
+
+            const result = await contract.sarproof(eown.account, hashOne, prov.account, eown.permission);
+            assert.isTrue(result.complete);
+            assert.equal(result.root, (await util.getRulesRoot()).root);
+            const [trustsGrantee, trustsOwner, enclaveAccess, granteeAccess, approve] = result.rules;
+            const scriptId = result.script_id;
+            assert.isFalse(trustsGrantee.found);
+            assert.isTrue(RulesProof.verify(result.root, RulesProof.makeTrustKey(eown.account, sown.account), trustsOwner));
+            assert.isTrue(RulesProof.verify(result.root, RulesProof.makeEnclaveAccessKey(eown.account, scriptId, prov.account), enclaveAccess));
+            assert.isTrue(RulesProof.verify(result.root, RulesProof.makeGrantKey(prov.account, scriptId), granteeAccess));
+            assert.isTrue(RulesProof.verify(result.root, RulesProof.makeApproveKey(eown.account, scriptId), approve));
+            assert.isFalse(RulesProof.verify(result.root, RulesProof.makeGrantKey(prov.account, scriptId), { ...granteeAccess, value: false }));
+
+            await contract.denyaccess(sown.account, hashOne, prov.account, sown.permission);
+            const changed = await contract.sarproof(eown.account, hashOne, prov.account, eown.permission);
+            assert.notEqual(result.root, changed.root);
+            assert.isFalse(RulesProof.verify(changed.root, RulesProof.makeGrantKey(prov.account, scriptId), granteeAccess));
+            assert.isTrue(RulesProof.verify(changed.root, RulesProof.makeGrantKey(prov.account, scriptId), changed.rules[3]));
+            assert.isFalse(changed.rules[3].value);
+        });
     });
 });
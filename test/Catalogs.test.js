@@ -29,6 +29,7 @@ describe('Catalogs', function () {
     beforeEach(async function () {
         await node.start();
         catalogs = await tools.makeAccount(bc, contractConfig.account);
+        await tools.activateFeatures(bc, config);
         await bc.deploy(catalogs.account, contractConfig.wasm, contractConfig.abi, catalogs.permission);
     });
 
@@ -72,6 +73,34 @@ describe('Catalogs', function () {
         });
     });
 
+    describe('#cities indexes', function () {
+        it('should select cities by region and type and by population', async () => {
+            await contract.regioninsert(16, 'en', 'region', catalogs.permission);
+            await contract.regioninsert(17, 'en', 'other', catalogs.permission);
+            await contract.citytypeins(111, 'en', 'aaa', catalogs.permission);
+            await contract.citytypeins(222, 'en', 'bbb', catalogs.permission);
+            await contract.cityinsert(1, 16, 111, 'en', 'A', 1000, catalogs.permission);
+            await contract.cityinsert(2, 16, 222, 'en', 'B', 3000, catalogs.permission);
+            await contract.cityinsert(3, 16, 111, 'en', 'C', 2000, catalogs.permission);
+            await contract.cityinsert(4, 17, 111, 'en', 'D', 9000, catalogs.permission);
+
+            assert.deepEqual([1, 3], (await util.getCitiesByRegionType(16, 111)).map(c => c.id));
+            assert.deepEqual([2, 3], (await util.getTopCitiesByRegion(16, 2)).map(c => c.id));
+            assert.equal(6000, (await util.getRegions())[0].population);
+
+            await contract.citychtype(3, 222, catalogs.permission);
+            assert.deepEqual([2, 3], (await util.getCitiesByRegionType(16, 222)).map(c => c.id));
+            await contract.cityremove(2, catalogs.permission);
+            assert.deepEqual([3, 1], (await util.getTopCitiesByRegion(16, 10)).map(c => c.id));
+            assert.equal(3000, (await util.getRegions())[0].population);
+
+            await contract.citymigrate(10, catalogs.permission);
+            await contract.citymigrate(10, catalogs.permission)
+                .should.be.rejectedWith('403. Cities are already migrated!');
+            assert.equal(3000, (await util.getRegions())[0].population);
+        });
+    });
+
     describe('#cities translations', function () {
         it('should insert city with translations', async () => {
             await contract.citytypeins(999, 'en', 'citytype', catalogs.permission);
@@ -99,6 +128,23 @@ describe('Catalogs', function () {
             assert.isUndefined(await util.getCityName('en', 111));
             assert.isUndefined(await util.getCityName('fr', 111));
         });
+        it('should track city translations languages', async () => {
+            await contract.citytypeins(999, 'en', 'citytype', catalogs.permission);
+            await contract.regioninsert(16, 'en', 'region', catalogs.permission);
+            await contract.cityinsert(111, 16, 999, 'en', 'AAA', 1000, catalogs.permission);
+            await contract.citytrans(111, 'fr', 'AAA', catalogs.permission);
+            await contract.citytrans(111, 'fr', 'BBB', catalogs.permission);
+            assert.deepEqual(['en', 'fr'], await util.getTranslationLangs('ctr', 111));
+            // Fresh deployment has nothing to index.
+            await contract.transindex(100, catalogs.permission)
+                .should.be.rejectedWith('403. Translations are already indexed!');
+            await contract.citytrans(111, 'de', 'CCC', catalogs.permission);
+            await contract.cityremove(111, catalogs.permission);
+            assert.deepEqual([], await util.getTranslationLangs('ctr', 111));
+            assert.lengthOf(await util.getCitiesByLang('en'), 0);
+            assert.lengthOf(await util.getCitiesByLang('fr'), 0);
+            assert.lengthOf(await util.getCitiesByLang('de'), 0);
+        });
     });
 
     describe('#regions translations', function () {
@@ -357,6 +403,149 @@ describe('Catalogs', function () {
         });
     });
 
+    describe('#paths', function () {
+        it('should keep paths and descendants of inserted and removed categories', async () => {
+            await contract.catupsert(1, null, 'en', 'A', catalogs.permission);
+            await contract.catupsert(2, 1, 'en', 'B', catalogs.permission);
+            await contract.catupsert(3, 2, 'en', 'C', catalogs.permission);
+            const info = await util.getCategoryPathInfo(3);
+            assert.equal(2, info.depth);
+            assert.deepEqual([1, 2], info.ancestors.map(Number));
+            assert.equal(2, (await util.getCategoryPathInfo(1)).descendants);
+            assert.deepEqual({ a0: 'A', a1: 'B', a2: 'C', a3: null, a4: null }, await util.getCategoryPath(3, 'en'));
+            assert.deepEqual(['A', 'B', 'C'], await contract.catpath(3, 'en', catalogs.permission));
+            assert.deepEqual(['', '', ''], await contract.catpath(3, 'fr', catalogs.permission));
+            await contract.catremove(3, catalogs.permission);
+            assert.equal(1, (await util.getCategoryPathInfo(1)).descendants);
+            assert.isUndefined(await util.getCategoryPathInfo(3));
+        });
+        it('should reparent subtree', async () => {
+            await contract.catupsert(1, null, 'en', 'A', catalogs.permission);
+            await contract.catupsert(2, 1, 'en', 'B', catalogs.permission);
+            await contract.catupsert(3, 2, 'en', 'C', catalogs.permission);
+            await contract.catupsert(4, 3, 'en', 'D', catalogs.permission);
+            await contract.catupsert(5, null, 'en', 'E', catalogs.permission);
+            await contract.catreparent(2, 5, catalogs.permission)
+                .should.be.rejectedWith('403. Category paths are not initialized');
+            await contract.catpathinit(10, catalogs.permission);
+            await contract.catreparent(2, 4, catalogs.permission)
+                .should.be.rejectedWith("403. Category can't be moved into its subtree");
+
+            await contract.catreparent(2, 5, catalogs.permission);
+            assert.equal(0, (await util.getCategoryPathInfo(1)).descendants);
+            assert.equal(3, (await util.getCategoryPathInfo(5)).descendants);
+            assert.equal(0, (await util.getCategoryById(1)).childs_count);
+            assert.equal(1, (await util.getCategoryById(5)).childs_count);
+            await contract.catupsert(6, 4, 'en', 'F', catalogs.permission)
+                .should.be.rejectedWith('403. Category paths sync is in progress');
+            // Descendants paths are stale until sync, parents are followed.
+            assert.deepEqual(['E', 'B', 'C', 'D'], await contract.catpath(4, 'en', catalogs.permission));
+
+            await contract.catpathsync(1, catalogs.permission);
+            await contract.catpathsync(10, catalogs.permission);
+            assert.deepEqual([5, 2, 3], (await util.getCategoryPathInfo(4)).ancestors.map(Number));
+            assert.deepEqual({ a0: 'E', a1: 'B', a2: 'C', a3: 'D', a4: null }, await util.getCategoryPath(4, 'en'));
+            await contract.catupsert(6, 4, 'en', 'F', catalogs.permission);
+            assert.equal(4, (await util.getCategoryPathInfo(5)).descendants);
+        });
+    });
+
+    describe('#import', function () {
+        it('should import categories with parents in the same batch', async () => {
+            await contract.catupsert(1, null, 'en', 'root', catalogs.permission);
+            await contract.catimport([
+                { id: 2, parent_id: 1, names: [{ lang: 'en', name: 'A' }, { lang: 'fr', name: 'A-fr' }] },
+                { id: 3, parent_id: 2, names: [{ lang: 'en', name: 'B' }] },
+                { id: 4, parent_id: 1, names: [{ lang: 'en', name: 'C' }] },
+            ], catalogs.permission);
+            assert.equal(2, (await util.getCategoryById(1)).childs_count);
+            assert.equal(1, (await util.getCategoryById(2)).childs_count);
+            assert.equal('A-fr', await util.getCategoryName('fr', 2));
+            await contract.catimport([{ id: 5, parent_id: 99, names: [{ lang: 'en', name: 'D' }] }], catalogs.permission)
+                .should.be.rejectedWith('404. Parent category not found');
+        });
+        it('should import cities and update counters once', async () => {
+            await contract.regionimport([
+                { id: 16, names: [{ lang: 'en', name: 'region' }] },
+                { id: 17, names: [{ lang: 'en', name: 'other' }] },
+            ], catalogs.permission);
+            await contract.citytypeins(999, 'en', 'citytype', catalogs.permission);
+            await contract.cityimport([
+                { id: 1, region_id: 16, type_id: 999, population: 10, names: [{ lang: 'en', name: 'A' }, { lang: 'ru', name: 'А' }] },
+                { id: 2, region_id: 16, type_id: 999, population: 20, names: [{ lang: 'en', name: 'B' }] },
+                { id: 3, region_id: 17, type_id: 999, population: 30, names: [{ lang: 'en', name: 'C' }] },
+            ], catalogs.permission);
+            const regions = await util.getRegions();
+            assert.deepEqual([2, 1], regions.map(r => r.cities_count));
+            assert.equal(3, (await util.getCityTypes())[0].cities_count);
+            assert.equal('А', (await util.getCityById(1)).name);
+            assert.lengthOf(await util.getCitiesByLang('en'), 3);
+            await contract.cityimport([{ id: 4, region_id: 18, type_id: 999, population: 1, names: [{ lang: 'en', name: 'D' }] }], catalogs.permission)
+                .should.be.rejectedWith('404. Region not found');
+        });
+        it('should import places', async () => {
+            await contract.placeimport([
+                { id: 1, names: [{ lang: 'en', name: 'A' }] },
+                { id: 2, names: [{ lang: 'en', name: 'B' }, { lang: 'de', name: 'B-de' }] },
+            ], catalogs.permission);
+            assert.lengthOf(await util.getPlaces(), 2);
+            assert.equal('B-de', await util.getPlaceName('de', 2));
+        });
+    });
+
+    describe('#journal', function () {
+        it('should return changes since revision', async () => {
+            await contract.catupsert(1, null, 'en', 'root', catalogs.permission);
+            await contract.catuptrans(1, 'fr', 'root-fr', catalogs.permission);
+            await contract.placeinsert(7, 'en', 'place', catalogs.permission);
+            await contract.placeremove(7, catalogs.permission);
+            assert.equal(4, (await util.getRevision()).revision);
+
+            const result = await util.getChanges(1);
+            assert.isTrue(result.complete);
+            assert.deepEqual([2, 3, 4], result.changes.map(c => c.revision));
+            assert.deepEqual({ revision: 2, kind: 0, entity_id: 1, lang: 'fr', op: 1 }, result.changes[0]);
+            assert.deepEqual({ revision: 4, kind: 4, entity_id: 7, lang: '', op: 2 }, result.changes[2]);
+            assert.lengthOf((await util.getChanges(4)).changes, 0);
+        });
+        it('should journal counters of related rows', async () => {
+            await contract.catupsert(1, null, 'en', 'root', catalogs.permission);
+            await contract.catupsert(2, 1, 'en', 'child', catalogs.permission);
+            await contract.vendinsert(3, 'vendor', catalogs.permission);
+            await contract.brandinsert(4, 'brand', catalogs.permission);
+            await contract.bindBrandToVendor(3, 4, catalogs.permission);
+            await contract.regioninsert(5, 'en', 'region', catalogs.permission);
+            await contract.citytypeins(6, 'en', 'type', catalogs.permission);
+            const revision = (await util.getRevision()).revision;
+            await contract.cityinsert(7, 5, 6, 'en', 'city', 100, catalogs.permission);
+
+            const changes = (await util.getChanges(0)).changes.map(c => [c.kind, c.entity_id, c.op]);
+            assert.deepInclude(changes, [0, 1, 1]);
+            assert.deepInclude(changes, [5, 3, 1]);
+            assert.deepInclude(changes, [6, 4, 1]);
+            const cityChanges = (await util.getChanges(revision)).changes.map(c => [c.kind, c.entity_id, c.op]);
+            assert.sameDeepMembers([[1, 5, 1], [3, 6, 1], [2, 7, 0]], cityChanges);
+        });
+        it('should compact journal', async () => {
+            await contract.regionimport([
+                { id: 1, names: [{ lang: 'en', name: 'A' }] },
+                { id: 2, names: [{ lang: 'en', name: 'B' }] },
+                { id: 3, names: [{ lang: 'en', name: 'C' }] },
+            ], catalogs.permission);
+            await contract.catcompact(3, 1, catalogs.permission);
+            assert.equal(2, (await util.getRevision()).compacted_before);
+            await contract.catcompact(3, 10, catalogs.permission);
+            assert.equal(3, (await util.getRevision()).compacted_before);
+
+            assert.isFalse((await util.getChanges(0)).complete);
+            const result = await util.getChanges(2);
+            assert.isTrue(result.complete);
+            assert.deepEqual([3], result.changes.map(c => c.entity_id));
+            await contract.catcompact(5, 1, catalogs.permission)
+                .should.be.rejectedWith('403. Revision is in the future!');
+        });
+    });
+
     describe('#vendors', function () {
         it('should add vendor and assign auto generated id', async () => {
             await contract.vendinsert(null, 'abc', catalogs.permission);
@@ -0,0 +1,78 @@
+const AggregionBlockchain = require('../js/AggregionBlockchain.js');
+const AggregionNode = require('../js/AggregionNode.js');
+const AggregionContract = require('../js/AggregionContract.js');
+const TestConfig = require('./TestConfig.js');
+const tools = require('./TestTools.js');
+
+const chai = require('chai')
+const crypto = require('crypto');
+const fs = require('fs');
+var assert = chai.assert;
+
+/**
+ * CPU usage of script lookup by (owner, script, version) key,
+ * measured against contract built before packed keys ('aggregion_baseline' in config).
+ * Measured 'updscript' keeps script hash, so both contracts do the same reads and writes
+ * and differ in key derivation only ('addscript' and 'sendreq' write more rows since then).
+ * Medians are written to 'keys-cpu.json' in node workdir.
+ */
+describe('KeysCpu', function () {
+
+    const config = new TestConfig(__dirname + '/config.json')
+    const contractConfig = config.contracts.aggregion;
+    const baselineConfig = config.contracts.aggregion_baseline;
+
+    let node = new AggregionNode(config.getSignatureProvider(), config.node.executable, config.node.endpoint, config.node.workdir);
+    let bc = new AggregionBlockchain(config.getNodeUrl(), [config.blockchain.eosio_root_key.private], config.debug);
+    let contract = new AggregionContract(contractConfig.account, bc);
+
+    const iterations = 25;
+
+    this.timeout(0);
+
+    before(function () {
+        if (!baselineConfig) {
+            this.skip();
+        }
+    });
+
+    afterEach(async function () {
+        await node.stop();
+    });
+
+    const toName = (i) => [...i.toString(5)].map(d => String.fromCharCode(97 + Number(d))).join('');
+    const makeHash = (prefix, i) => crypto.createHash('sha256').update(prefix + i).digest('hex');
+    const cpu = (txinfo) => txinfo.processed.receipt.cpu_usage_us;
+    const median = (values) => {
+        const sorted = [...values].sort((a, b) => a - b);
+        return sorted[Math.floor(sorted.length / 2)];
+    };
+
+    const measure = async (wasm, abi) => {
+        await node.start();
+        await tools.activateFeatures(bc, config);
+        const aggregion = await tools.makeAccount(bc, contractConfig.account);
+        await bc.deploy(aggregion.account, wasm, abi, aggregion.permission);
+        const alice = await tools.makeAccount(bc, 'alice');
+        await contract.regprov(alice.account, 'Alice provider', alice.permission);
+
+        let usage = [];
+        for (let i = 0; i < iterations; ++i) {
+            const version = 'v' + toName(i);
+            const hash = makeHash('a', i);
+            await contract.addscript(alice.account, 'script', version, 'description', hash, 'http://example.com', alice.permission);
+            usage.push(cpu(await contract.updscript(alice.account, 'script', version, 'updated ' + i, hash, 'http://example.com', alice.permission)));
+        }
+        await node.stop();
+        return usage;
+    };
+
+    it('should measure cpu usage of script key lookup against baseline', async () => {
+        const before = median(await measure(baselineConfig.wasm, baselineConfig.abi));
+        const after = median(await measure(contractConfig.wasm, contractConfig.abi));
+        assert.isAbove(before, 0);
+        assert.isAbove(after, 0);
+        const result = { action: 'updscript', iterations: iterations, baseline_cpu_usage_us: before, current_cpu_usage_us: after };
+        fs.writeFileSync(config.node.workdir + '/keys-cpu.json', JSON.stringify(result, null, 2));
+    });
+});
@@ -13,6 +13,10 @@ class TestConfig {
         return "http://" + this.node.endpoint;
     }
 
+    getStateHistoryUrl() {
+        return "ws://" + this.node.state_history_endpoint;
+    }
+
     getSignatureProvider() {
         const pub = this.blockchain.eosio_root_key.public;
         const prv = this.blockchain.eosio_root_key.private;
@@ -24,5 +24,33 @@ module.exports = {
         await blockchain.newaccount('eosio', name, ownerKey, activeKey, 'eosio@active');
         await blockchain.addPrivateKey(pair.privateKey);
         return new TestAccount(name, ownerKey, pair.privateKey);
+    },
+
+    /**
+     * Activate protocol features required by contracts (read-only actions return values).
+     * @param {AggregionBlockchain} blockchain
+     * @param {Object} config test config with 'boot' contract
+     */
+    activateFeatures: async function (blockchain, config) {
+        await blockchain.activateFeatures(['ACTION_RETURN_VALUE'], config.contracts.boot.wasm, config.contracts.boot.abi);
+    },
+
+    /**
+     * Write pre-upgrade rows by contract built before migrations ('aggregion_baseline' in config),
+     * then upgrade account to current contract. Test is skipped if config has no baseline contract.
+     * @param {Mocha.Context} test
+     * @param {AggregionBlockchain} blockchain
+     * @param {Object} config test config
+     * @param {TestAccount} account contract account
+     * @param {Function} write pushes pre-upgrade actions
+     */
+    upgradeFromBaseline: async function (test, blockchain, config, account, write) {
+        const baseline = config.contracts.aggregion_baseline;
+        if (!baseline) {
+            test.skip();
+        }
+        await blockchain.deploy(account.account, baseline.wasm, baseline.abi, account.permission);
+        await write();
+        await blockchain.deploy(account.account, config.contracts.aggregion.wasm, config.contracts.aggregion.abi, account.permission);
     }
 };
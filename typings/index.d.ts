@@ -10,11 +10,22 @@ export declare class AggregionBlockchain {
     getTableRows(contractAccount: any, tableName: any, scopeName: any, primaryKeyValue?: any): Promise<{
         rows: any[];
     }>;
-    getTableRowsByIndex(contractAccount: any, tableName: any, scopeName: any, indexPosition: any, keyType: any, fromKey: any, toKey: any): Promise<{
+    getTableRowsByIndex(contractAccount: any, tableName: any, scopeName: any, indexPosition: any, keyType: any, fromKey: any, toKey: any, limit?: Number): Promise<{
         rows: any[];
     }>;
-    pushAction(contractAccount: any, actionName: any, requestObject: any, permission: any): Promise<void>;
+    pushTransaction(actions: any[]): Promise<any>;
+    pushAction(contractAccount: any, actionName: any, requestObject: any, permission: any): Promise<any>;
     deploy(contractAccount: any, wasmPath: any, abiPath: any, permission: any): Promise<void>;
+    /**
+     * Allow contract to send inline 'action' on behalf of its own 'codePermission' (child of active),
+     * which is linked to that action only.
+     */
+    addCodePermission(contractAccount: any, codePermission: string, action: string, permission: any): Promise<void>;
+    /**
+     * Activate protocol features (e.g. 'ACTION_RETURN_VALUE') with their dependencies.
+     * Requires 'producer_api_plugin', 'eosio.boot' contract is deployed to 'eosio' account.
+     */
+    activateFeatures(codenames: string[], bootWasmPath: string, bootAbiPath: string): Promise<void>;
     newaccount(creatorName: any, accountName: any, ownerKey: any, activeKey: any, permission: any): Promise<void>;
     newaccountram(creator: any, name: any, owner: any, active: any, net: any, cpu: any, transfer: any, bytes: any, permission: any): Promise<void>;
 }
@@ -49,6 +60,19 @@ export declare class AggregionContract {
      * @param {permission} permission
      */
     unregprov(name: any, permission: any): Promise<void>;
+    /**
+     * Continue pending provider unregistration.
+     * @param {EosioName} name
+     * @param {Number} maxRows
+     * @param {permission} permission
+     */
+    cleanup(name: any, maxRows: Number, permission: any): Promise<void>;
+    /**
+     * Get provider counters (read-only).
+     * @param {EosioName} provider
+     * @param {permission} permission
+     */
+    getprovstats(provider: any, permission: any): Promise<ProviderStats>;
     /**
      * Create new provider service.
      * @param {EosioName} provider
@@ -108,6 +132,14 @@ export declare class AggregionContract {
      * @param {permission} permission
      */
     remscript(user: any, script: any, version: any, permission: any): Promise<void>;
+    /**
+     * Get highest version of script (read-only).
+     * Versions are compared as names, not by insertion time ('v10' goes before 'v9').
+     * @param {EosioName} user
+     * @param {EosioName} script
+     * @param {permission} permission
+     */
+    latestscript(user: any, script: any, permission: any): Promise<any>;
 
     /**
      * Trust provider.
@@ -147,8 +179,9 @@ export declare class AggregionContract {
      * @param {string} script_hash
      * @param {EosioName} grantee
      * @param {permission} permission
+     * @param {Number} expiresAt Optional grant expiry (seconds since epoch).
      */
-    grantaccess(owner: any, script_hash: any, grantee: any, permission: any): Promise<void>;
+    grantaccess(owner: any, script_hash: any, grantee: any, permission: any, expiresAt?: number): Promise<void>;
 
     /**
      * Deny provider access to script.
@@ -166,8 +199,89 @@ export declare class AggregionContract {
      * @param {EosioName} grantee
      * @param {Boolean} granted
      * @param {permission} permission
+     * @param {Number} expiresAt Optional grant expiry (seconds since epoch).
      */
-    async enclaveScriptAccess(enclaveOwner: any, script_hash: any, grantee: any, granted: any, permission: any): Promise<void>;
+    async enclaveScriptAccess(enclaveOwner: any, script_hash: any, grantee: any, granted: any, permission: any, expiresAt?: number): Promise<void>;
+
+    /**
+     * Set access of every grantee to every script of owner.
+     * At most 500 (script, grantee) pairs per call.
+     * @param {EosioName} owner
+     * @param {string[]} hashes
+     * @param {EosioName[]} grantees
+     * @param {Boolean} granted
+     * @param {permission} permission
+     * @param {Number} expiresAt Optional grant expiry (seconds since epoch).
+     */
+    grantmany(owner: any, hashes: string[], grantees: any[], granted: boolean, permission: any, expiresAt?: number): Promise<void>;
+
+    /**
+     * Set access of every grantee to every script within enclave.
+     * At most 500 (script, grantee) pairs per call.
+     * @param {EosioName} enclaveOwner
+     * @param {string[]} hashes
+     * @param {EosioName[]} grantees
+     * @param {Boolean} granted
+     * @param {permission} permission
+     * @param {Number} expiresAt Optional grant expiry (seconds since epoch).
+     */
+    encgrantmany(enclaveOwner: any, hashes: string[], grantees: any[], granted: boolean, permission: any, expiresAt?: number): Promise<void>;
+
+    /**
+     * Remove expired script and enclave grants.
+     * @param {Number} maxRows
+     * @param {permission} permission
+     */
+    sweepgrants(maxRows: number, permission: any): Promise<void>;
+
+    /**
+     * Apply queued trust updates to trusted approves counts.
+     * @param {Number} maxRows
+     * @param {permission} permission
+     */
+    synctrust(maxRows: number, permission: any): Promise<void>;
+
+    /**
+     * Rewrite table rows with current secondary keys version.
+     * @param {EosioName} table
+     * @param {Number} maxRows
+     * @param {permission} permission
+     */
+    migrate(table: any, maxRows: Number, permission: any): Promise<void>;
+
+    /**
+     * Move deprecated enclave permissions into normalized table.
+     * @param {EosioName} enclaveOwner
+     * @param {Number} maxRows
+     * @param {permission} permission
+     */
+    migrateesa(enclaveOwner: any, maxRows: Number, permission: any): Promise<void>;
+
+    /**
+     * Resolve script execution rules within enclave.
+     * @param {EosioName} enclaveOwner
+     * @param {string} script_hash
+     * @param {EosioName} grantee
+     * @param {permission} permission
+     */
+    canexec(enclaveOwner: any, script_hash: any, grantee: any, permission: any): Promise<ExecutionVerdict>;
+
+    /**
+     * Enclave permissions matrix as bitsets (read-only).
+     * @param {EosioName} enclaveOwner
+     * @param {permission} permission
+     */
+    encsnapshot(enclaveOwner: any, permission: any): Promise<EnclaveSnapshotResult>;
+
+    /**
+     * Access rules root with inclusion proofs of execution rules (read-only).
+     * Rules order: owner trusts grantee, owner trusts script owner, enclave access, grantee access, owner approve.
+     * @param {EosioName} enclaveOwner
+     * @param {string} script_hash
+     * @param {EosioName} grantee
+     * @param {permission} permission
+     */
+    sarproof(enclaveOwner: any, script_hash: any, grantee: any, permission: any): Promise<RulesProofResult>;
 
     /**
      * Log request.
@@ -178,8 +292,50 @@ export declare class AggregionContract {
      * @param {permission} permission
      */
     sendreq(sender: string, receiver: string, date: any, body: string, permission: any): Promise<void>;
+    /**
+     * Get sender requests traffic per receiver per day (read-only).
+     * @param {EosioName} sender
+     * @param {int} fromDay
+     * @param {int} toDay
+     * @param {permission} permission
+     */
+    getreqstats(sender: any, fromDay: number, toDay: number, permission: any): Promise<RequestsStats[]>;
+    /**
+     * Set requests log retention window, seconds behind current block time.
+     * @param {int} retention
+     * @param {permission} permission
+     */
+    setretention(retention: number, permission: any): Promise<void>;
+    /**
+     * Prune requests log.
+     * @param {int} beforeDate
+     * @param {int} maxRows
+     * @param {permission} permission
+     */
+    prunereqs(beforeDate: number, maxRows: number, permission: any): Promise<void>;
 }
 
+export type ProviderStats = {
+    provider: string;
+    services: number;
+    scripts: number;
+    trusts: number;
+    approves: number;
+    grants: number;
+};
+
+export type ExecutionVerdict = {
+    script_found: boolean;
+    script_id: Number;
+    script_owner: string;
+    enclave_access?: boolean;
+    grantee_access?: boolean;
+    owner_approved?: boolean;
+    owner_trusts_grantee: boolean;
+    owner_trusts_script_owner: boolean;
+    trusted_approves: Number;
+};
+
 export type UserInfo = {
     email: string;
     firstname: string;
@@ -207,7 +363,7 @@ export declare class DmpusersContract {
 
 /// <reference types="node" />
 export declare class AggregionNode {
-    constructor(signatureProvider: any, endpoint: any, workdir: any);
+    constructor(signatureProvider: any, nodeos: any, endpoint: any, workdir: any, stateHistoryEndpoint?: string);
     start(): Promise<void>;
     stop(): Promise<void>;
 }
@@ -221,6 +377,127 @@ export declare class TablesUtility {
     getTableByIndex(tableName: any, indexPosition: any, keyType: any, keyValue: any): Promise<any[]>;
 }
 
+export type EnclaveSnapshotResult = {
+    time: number;
+    valid_until: number;
+    scripts: number[];
+    grantees: string[];
+    known: string;
+    granted: string;
+};
+
+/**
+ * In-memory enclave permissions matrix returned by 'encsnapshot'.
+ */
+export declare class EnclaveSnapshot {
+    /**
+     * @param {Object} snapshot 'encsnapshot' result
+     */
+    constructor(snapshot: EnclaveSnapshotResult);
+    time: number;
+    validUntil: number;
+    scripts: Map<string, number>;
+    grantees: Map<string, number>;
+    known: Buffer;
+    granted: Buffer;
+    static testBit(bits: Buffer, bit: number): boolean;
+    /**
+     * Permission of grantee to run script within enclave.
+     * @returns {Boolean|undefined} undefined if there is no permission
+     */
+    isGranted(scriptId: any, grantee: string): boolean | undefined;
+}
+
+export type RuleProof = {
+    kind: number;
+    found: boolean;
+    index: number;
+    value: boolean;
+    expires_at: number;
+    siblings: string[];
+};
+
+export type RulesProofResult = {
+    root: string;
+    complete: boolean;
+    script_found: boolean;
+    script_id: number;
+    script_owner: string;
+    rules: RuleProof[];
+};
+
+/**
+ * Offline verification of access rules proofs returned by 'sarproof'.
+ */
+export declare class RulesProof {
+    static get Kind(): { Trust: number, Approve: number, Grant: number, EnclaveAccess: number };
+    static makeRuleKey(kind: number, ...words: any[]): string;
+    static makeTrustKey(truster: string, trustee: string): string;
+    static makeApproveKey(approver: string, scriptId: any): string;
+    static makeGrantKey(grantee: string, scriptId: any): string;
+    static makeEnclaveAccessKey(enclaveOwner: string, scriptId: any, grantee: string): string;
+    static hashLeaf(ruleKey: string, value: boolean, expiresAt: number): string;
+    static hashNode(left: string, right: string): string;
+    static computeRoot(ruleKey: string, proof: RuleProof): string;
+    static verify(root: string, ruleKey: string, proof: RuleProof): boolean;
+}
+
+export declare class KeysUtility {
+    static nameToBigInt(name: string): BigInt;
+    static makeKey128(high: any, low: any): string;
+    static makeKey256(...words: any[]): string;
+    static hashKeys(a: string, b: string): string;
+    static makeServiceKind(type: string, protocol: string): string;
+    static makeRequestKey(sender: string, receiver: string, date: number, request: string): string;
+    static orderedInt32(value: any): BigInt;
+}
+
+export type RequestsStats = {
+    id: number;
+    receiver: string;
+    day: number;
+    count: number;
+    bytes: number;
+};
+
+export type RequestDescriptor = {
+    id: number;
+    sender: string;
+    receiver: string;
+    date: number;
+    request_hash: string;
+};
+
+/**
+ * Delivers 'reqnotify' notifications of receiver account.
+ * Reads action traces pushed by 'state_history_plugin' websocket ('--trace-history' enabled).
+ */
+export declare class RequestsSubscription {
+    constructor(contractAccount: any, blockchain: AggregionBlockchain, receiver: any, callback: (request: RequestDescriptor) => any, stateHistoryUrl: string,
+        onError?: (error: any) => any);
+    contractAccount: any;
+    bc: AggregionBlockchain;
+    receiver: any;
+    url: string;
+    interval: number;
+    maxBackoff: number;
+    messagesInFlight: number;
+    nextBlock: number;
+    failures: number;
+    irreversibleOnly: boolean;
+    /**
+     * Start delivery of notifications.
+     * @param {Number} fromBlock first block to read, next to head block by default
+     * @param {Boolean} irreversibleOnly deliver notifications of irreversible blocks only
+     */
+    start(fromBlock?: number, irreversibleOnly?: boolean): Promise<void>;
+    stop(): void;
+    /**
+     * Resolves when notifications of blocks up to 'blockNum' are delivered.
+     */
+    waitBlock(blockNum: number): Promise<void>;
+}
+
 export declare class AggregionUtility {
     /**
      * @param {AggregionBlockchain} blockchain
@@ -228,17 +505,64 @@ export declare class AggregionUtility {
     constructor(contractAccount: any, blockchain: AggregionBlockchain);
     getProviders(): Promise<any[]>;
     getServices(): Promise<any[]>;
+    /**
+     * Services of all providers with given type and protocol ({scope, service, info}),
+     * read from discovery rows by one range query.
+     */
+    findServices(type: string, protocol: string): Promise<any[]>;
     getScripts(): Promise<any[]>;
     getApproves(): Promise<any[]>;
     getRequestsLog(): Promise<any[]>;
+    getRequestPayload(hash: string): Promise<any>;
+    /**
+     * Fill 'request' of log rows which reference shared payload.
+     */
+    resolveRequestsPayloads(rows: any[]): Promise<any[]>;
+    getRequestsConfig(): Promise<any>;
+    getRequestsCheckpoints(): Promise<any[]>;
+    getRequestsByDate(indexPosition: number, account: any, fromDate: number, toDate: number): Promise<any[]>;
+    getRequestsStats(sender: any, fromDay: number, toDay: number): Promise<RequestsStats[]>;
+    getRequestsByReceiver(receiver: any, fromDate: number, toDate: number): Promise<any[]>;
+    getRequestsBySender(sender: any, fromDate: number, toDate: number): Promise<any[]>;
     getProviderByName(name: any): Promise<any>;
+    getProviderStats(name: any): Promise<ProviderStats>;
     isProviderExists(name: any): Promise<boolean>;
+    isProviderRemoving(name: any): Promise<boolean>;
     getService(provider: any, service: any): Promise<any>;
     getScript(owner: any, script: any, version: any): Promise<any>;
+    getScriptVersions(owner: any, script: any): Promise<any[]>;
     getScriptByHash(hash: any): Promise<boolean>;
+    getScriptStats(scriptId: any): Promise<any>;
     isTrusted(truster: any, trustee: any): Promise<boolean>;
+    /**
+     * Providers which trust given provider.
+     */
+    getTrusters(trustee: any): Promise<string[]>;
+    /**
+     * Number of script approves made by providers trusted by truster.
+     */
+    getTrustedApproves(truster: any, scriptId: any): Promise<number>;
+    /**
+     * Trust and approve changes not yet applied to trusted approves counts, in queue order.
+     */
+    getTrustUpdates(): Promise<any[]>;
+    getScriptApprovers(scriptId: any): Promise<any[]>;
+    getScriptGrantees(scriptId: any): Promise<any[]>;
     isScriptApprovedBy(provider: any, hash: any): Promise<boolean>;
     isScriptAccessGrantedTo(grantee: any, hash: any): Promise<boolean>;
+    /**
+     * Grant with expiry is denied since 'expires_at' (seconds since epoch).
+     */
+    static isExpired(grant: any): boolean;
+    /**
+     * Expiry queue of time-bounded grants.
+     */
+    getGrantsExpiry(): Promise<any[]>;
+    /**
+     * Access rules commitment root and number of leaf slots.
+     */
+    getRulesRoot(): Promise<any>;
+    getEnclaveAccess(enclaveOwner: any, scriptId: any, grantee: any): Promise<any>;
     isScriptAllowedWithinEnclave(enclaveOwner: any, hash: any, grantee: any): Promise<boolean>;
 }
 
@@ -266,6 +590,7 @@ export declare class CatalogsContract {
     catupsert(categoryId: Number, parentId: Number, lang: string, name: string, permission: any): Promise<void>;
     catuptrans(categoryId: Number, lang: string, name: string, permission: string): Promise<void>;
     catremove(categoryId: Number, permission: any): Promise<void>;
+    catimport(items: any[], permission: any): Promise<void>;
 
     vendinsert(vendorId: Number, name: string, permission: any): Promise<void>;
     vendremove(vendorId: Number, permission: any): Promise<void>;
@@ -278,6 +603,7 @@ export declare class CatalogsContract {
     regioninsert(regionId: Number, lang: string, name: string, permission: any): Promise<void>;
     regionupdate(regionId: Number, lang: string, name: string, permission: any): Promise<void>;
     regionremove(regionId: Number, permission: any): Promise<void>;
+    regionimport(items: any[], permission: any): Promise<void>;
 
     citytypeins(citytypeId: Number, lang: string, name: string, permission: any): Promise<void>;
     citytypetrn(citytypeId: Number, lang: string, name: string, permission: any): Promise<void>;
@@ -287,10 +613,37 @@ export declare class CatalogsContract {
     citytrans(cityId: Number, lang: string, name: string, permission: string): Promise<void>;
     citychtype(cityId: Number, cityTypeId: Number, permission: string): Promise<void>;
     cityremove(cityId: Number, permission: any): Promise<void>;
+    cityimport(items: any[], permission: any): Promise<void>;
 
     placeinsert(placeId: Number, lang: string, name: string, permission: any): Promise<void>;
     placeupdate(placeId: Number, lang: string, name: string, permission: any): Promise<void>;
     placeremove(placeId: Number, permission: any): Promise<void>;
+    placeimport(items: any[], permission: any): Promise<void>;
+    /**
+     * Index cities written before (region, type) and (region, population) indexes were introduced.
+     */
+    citymigrate(maxRows: Number, permission: any): Promise<void>;
+    catreparent(id: Number, parentId: Number | null, permission: any): Promise<void>;
+    /**
+     * Rewrite paths of moved categories descendants.
+     */
+    catpathsync(maxRows: Number, permission: any): Promise<void>;
+    /**
+     * Create paths of categories created before paths were introduced.
+     */
+    catpathinit(maxRows: Number, permission: any): Promise<void>;
+    /**
+     * Category names in 'lang' from root to category (read-only), read by one request.
+     */
+    catpath(id: Number, lang: string, permission: any): Promise<string[]>;
+    /**
+     * Index languages of translations written before languages index was introduced.
+     */
+    transindex(maxRows: Number, permission: any): Promise<void>;
+    /**
+     * Remove journal changes older than specified revision.
+     */
+    catcompact(beforeRevision: Number, maxRows: Number, permission: any): Promise<void>;
 }
 
 
@@ -304,6 +657,7 @@ export declare class CatalogsUtility {
     getCategoryName(lang: any, categoryId: any): Promise<any>;
     getCategoryById(id: any): Promise<any>;
     getSubcategories(parentId: any): Promise<any[]>;
+    getCategoryPathInfo(id: any): Promise<{ id: Number, depth: Number, ancestors: Number[], descendants: Number } | undefined>;
     getCategoryPath(id: any): Promise<{
         a0: any;
         a1: any;
@@ -328,10 +682,27 @@ export declare class CatalogsUtility {
     getCitiesByLang(lang: any): Promise<any[]>;
     getCityName(lang: any, cityId: any): Promise<any[]>;
     getCitiesByRegion(regionId: any): Promise<any[]>;
+    getCitiesByRegionType(regionId: any, typeId: any): Promise<any[]>;
+    getTopCitiesByRegion(regionId: any, limit: Number): Promise<any[]>;
 
     getPlaces(): Promise<any[]>;
     getPlacesByLang(lang: any): Promise<any[]>;
     getPlaceName(lang: any, placeId: any): Promise<any[]>;
+    /**
+     * Languages of entity translations.
+     * @param {String} table translations table ('cattrans', 'ctr', 'cttr', 'pltr', 'rtr')
+     * @param {Number} id entity id
+     */
+    getTranslationLangs(table: string, id: any): Promise<string[]>;
+    /**
+     * Last catalogs revision and first revision kept by journal.
+     */
+    getRevision(): Promise<{ revision: Number, compacted_before: Number }>;
+    /**
+     * Catalogs changes made after specified revision.
+     * @param {Number} sinceRevision last revision applied by replica
+     */
+    getChanges(sinceRevision: Number): Promise<{ revision: Number, complete: boolean, changes: any[] }>;
 }
 
 